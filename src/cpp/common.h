@@ -29,8 +29,13 @@
 #define TOVE_DEBUG 0
 #define TOVE_NANOFLANN 0
 
+#ifndef TOVE_TRACE
+#define TOVE_TRACE 0
+#endif
+
 #include "interface.h"
 #include "warn.h"
+#include "trace.h"
 
 #include <memory>
 #include <limits>
@@ -78,6 +83,14 @@ inline void store_gpu_float(uint16_t &p, float x) {
 }
 #endif
 
+inline float load_gpu_float(const float &p) {
+	return p;
+}
+
+inline float load_gpu_float(const uint16_t &p) {
+	return fp16_ieee_to_fp32_value(p);
+}
+
 typedef ClipperLib::Path ClipperPath;
 typedef ClipperLib::Paths ClipperPaths;
 typedef ClipperLib::IntPoint ClipperPoint;
@@ -106,6 +119,15 @@ typedef SharedPtr<AbstractFeed> FeedRef;
 class Palette;
 typedef SharedPtr<Palette> PaletteRef;
 
+class Timeline;
+typedef SharedPtr<Timeline> TimelineRef;
+
+class GraphicsSnapshot;
+typedef SharedPtr<GraphicsSnapshot> SnapshotRef;
+
+class AbstractJob;
+typedef SharedPtr<AbstractJob> JobRef;
+
 typedef SharedPtr<std::string> NameRef;
 
 inline int nextpow2(uint32_t v) {
@@ -0,0 +1,52 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_FOOTPRINT
+#define __TOVE_FOOTPRINT 1
+
+#include "common.h"
+#include <algorithm>
+#include <vector>
+
+BEGIN_TOVE_NAMESPACE
+
+// helpers for memory accounting (see ToveMemoryUsage). allocations are
+// counted by capacity; whatever exceeds the size in use is reclaimable.
+
+namespace footprint {
+	inline void add(
+		double &category,
+		ToveMemoryUsage &usage,
+		size_t size,
+		size_t capacity) {
+
+		category += capacity;
+		usage.reclaimable += capacity - std::min(size, capacity);
+	}
+
+	template<typename T>
+	inline void add(
+		double &category,
+		ToveMemoryUsage &usage,
+		const std::vector<T> &v) {
+
+		add(category, usage, v.size() * sizeof(T), v.capacity() * sizeof(T));
+	}
+
+	template<typename T>
+	inline void release(std::vector<T> &v) {
+		std::vector<T>().swap(v);
+	}
+} // namespace footprint
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_FOOTPRINT
@@ -0,0 +1,222 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "atlas_feed.h"
+#include "../graphics.h"
+#include "../path.h"
+#include "../utils.h"
+#include "../footprint.h"
+#include <cstring>
+#include <algorithm>
+
+BEGIN_TOVE_NAMESPACE
+
+enum {
+	HEADER_TEXELS = 2,
+	VERTICES_PER_PATH = 6,
+	ATLAS_VERTEX_STRIDE = 3 * sizeof(float) + 4
+};
+
+GPUXAtlasFeed::GPUXAtlasFeed(const GraphicsRef &graphics) :
+	graphics(graphics),
+	paints(graphics->getPaintIndices()) {
+
+	const int numPaths = graphics->getNumPaths();
+
+	// all paths share one shader, so they need to agree on the
+	// size of curve indices in their lists.
+	bool wideLists = false;
+	for (int i = 0; i < numPaths; i++) {
+		wideLists = wideLists ||
+			graphics->getPath(i)->getNumCurves() > MAX_GPUX_CURVES_8BIT;
+	}
+
+	int numCurves = 0;
+	int numListsRows = 0;
+	int listsWidth = 1;
+
+	entries.reserve(numPaths);
+	for (int i = 0; i < numPaths; i++) {
+		const PathRef &path = graphics->getPath(i);
+
+		entries.emplace_back(new Entry());
+		Entry &entry = *entries.back();
+		std::memset(&entry.lineColor, 0, sizeof(entry.lineColor));
+		std::memset(&entry.bounds, 0, sizeof(entry.bounds));
+		std::memset(&entry.meta, 0, sizeof(entry.meta));
+		entry.curvesRow = numCurves;
+		entry.listsRow = numListsRows;
+
+		if (!path->hasFill() || path->getNumCurves() < 1) {
+			std::memset(&entry.geometry, 0, sizeof(entry.geometry));
+			continue;
+		}
+
+		// strokes are not part of the atlas; they are drawn as meshes.
+		entry.feed.reset(new GeometryFeed(path, entry.geometry,
+			entry.lineColor, false, TOVE_GPUX_GRID, wideLists));
+
+		const ToveShaderGeometryData &g = entry.geometry;
+		numCurves += g.curvesTextureSize[1];
+		numListsRows += g.gridSize * g.gridSize;
+		listsWidth = std::max(listsWidth, g.listsTextureSize[0]);
+	}
+
+	std::memset(&data, 0, sizeof(data));
+	data.numPaths = numPaths;
+	data.numCurves = numCurves;
+
+	header.resize(std::max(numPaths, 1) * HEADER_TEXELS * 4);
+	data.headerTexture = header.data();
+	data.headerTextureRowBytes = HEADER_TEXELS * 4 * sizeof(float);
+	data.headerTextureSize[0] = HEADER_TEXELS;
+	data.headerTextureSize[1] = std::max(numPaths, 1);
+	data.headerTextureFormat = "rgba32f";
+
+	data.listsTextureRowBytes = listsWidth * 4;
+	data.listsTextureSize[0] = listsWidth;
+	data.listsTextureSize[1] = std::max(numListsRows, 1);
+	data.listsTextureFormat = "rgba8";
+	data.listsIndexSize = wideLists ? 2 : 1;
+	lists.resize(data.listsTextureRowBytes * data.listsTextureSize[1]);
+	data.listsTexture = lists.data();
+
+	const int curvesWidth = div4(16);
+	data.curvesTextureRowBytes = curvesWidth * 4 * sizeof(gpu_float_t);
+	data.curvesTextureSize[0] = curvesWidth;
+	data.curvesTextureSize[1] = std::max(numCurves, 1);
+	data.curvesTextureFormat = sizeof(gpu_float_t) == sizeof(float) ?
+		"rgba32f" : "rgba16f";
+	curves.resize(curvesWidth * 4 * data.curvesTextureSize[1]);
+	data.curvesTexture = curves.data();
+
+	data.vertexStride = ATLAS_VERTEX_STRIDE;
+	data.numVertices = numPaths * VERTICES_PER_PATH;
+	vertices.resize(std::max(data.numVertices, 1) * ATLAS_VERTEX_STRIDE);
+	data.vertices = vertices.data();
+
+	// redirect each path's texture data into its rows of the atlas.
+	for (auto &entry : entries) {
+		if (!entry->feed) {
+			continue;
+		}
+
+		ToveShaderGeometryData &g = entry->geometry;
+		assert(g.listsIndexSize == data.listsIndexSize);
+		assert(g.curvesTextureSize[0] == curvesWidth);
+
+		g.bounds = &entry->bounds;
+		g.lookupTableMeta = &entry->meta;
+
+		g.listsTextureRowBytes = data.listsTextureRowBytes;
+		g.listsTexture = data.listsTexture +
+			entry->listsRow * data.listsTextureRowBytes;
+
+		g.curvesTextureRowBytes = data.curvesTextureRowBytes;
+		g.curvesTexture = data.curvesTexture +
+			entry->curvesRow * data.curvesTextureRowBytes / sizeof(gpu_float_t);
+	}
+
+	for (int i = 0; i < numPaths; i++) {
+		updateHeader(i);
+		updateVertices(i);
+	}
+}
+
+void GPUXAtlasFeed::updateHeader(int i) {
+	const Entry &entry = *entries[i];
+	float *texel = header.data() + i * HEADER_TEXELS * 4;
+
+	std::memcpy(texel, entry.bounds.bounds, 4 * sizeof(float));
+	texel[4] = entry.curvesRow;
+	texel[5] = entry.listsRow;
+	texel[6] = entry.geometry.gridSize;
+	texel[7] = entry.geometry.fillRule;
+}
+
+void GPUXAtlasFeed::updateVertices(int i) {
+	const Entry &entry = *entries[i];
+	uint8_t *p = vertices.data() + i * VERTICES_PER_PATH * ATLAS_VERTEX_STRIDE;
+
+	// paths without fill get a degenerate quad.
+	const float *b = entry.bounds.bounds;
+	const float quad[VERTICES_PER_PATH][2] = {
+		{b[0], b[1]}, {b[2], b[1]}, {b[0], b[3]},
+		{b[0], b[3]}, {b[2], b[1]}, {b[2], b[3]}};
+
+	const uint32_t paint = paints->get(i).fill.toBytes();
+
+	for (int j = 0; j < VERTICES_PER_PATH; j++) {
+		const float xyz[3] = {quad[j][0], quad[j][1], float(i)};
+		std::memcpy(p, xyz, sizeof(xyz));
+		for (int k = 0; k < 4; k++) {
+			p[sizeof(xyz) + k] = (paint >> (8 * k)) & 0xff;
+		}
+		p += ATLAS_VERTEX_STRIDE;
+	}
+}
+
+ToveChangeFlags GPUXAtlasFeed::beginUpdate() {
+	if (graphics->getNumPaths() != int(entries.size())) {
+		return CHANGED_RECREATE;
+	}
+
+	ToveChangeFlags changes = 0;
+	for (int i = 0; i < int(entries.size()); i++) {
+		Entry &entry = *entries[i];
+		if (entry.feed) {
+			if (graphics->getPath(i)->getNumCurves() != entry.geometry.maxCurves) {
+				return CHANGED_RECREATE;
+			}
+			changes |= entry.feed->beginUpdate();
+		} else {
+			const PathRef &path = graphics->getPath(i);
+			if (path->hasFill() && path->getNumCurves() > 0) {
+				return CHANGED_RECREATE;
+			}
+		}
+	}
+	return changes;
+}
+
+ToveChangeFlags GPUXAtlasFeed::endUpdate() {
+	stats::Attribution attribution(graphics->getCounters());
+	ToveChangeFlags changes = 0;
+	for (int i = 0; i < int(entries.size()); i++) {
+		Entry &entry = *entries[i];
+		if (entry.feed) {
+			const ToveChangeFlags pathChanges = entry.feed->endUpdate();
+			if (pathChanges) {
+				updateHeader(i);
+				updateVertices(i);
+				changes |= pathChanges;
+			}
+		}
+	}
+	return changes;
+}
+
+void GPUXAtlasFeed::addMemoryUsage(ToveMemoryUsage &usage) const {
+	footprint::add(usage.geometry, usage, header);
+	footprint::add(usage.geometry, usage, lists);
+	footprint::add(usage.geometry, usage, curves);
+	footprint::add(usage.geometry, usage, vertices);
+
+	// the entries' textures are rows of the ones above.
+	for (const auto &entry : entries) {
+		usage.geometry += sizeof(Entry);
+		if (entry->feed) {
+			entry->feed->addMemoryUsage(usage);
+		}
+	}
+}
+
+END_TOVE_NAMESPACE
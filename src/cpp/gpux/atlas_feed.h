@@ -0,0 +1,71 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_GPUX_ATLAS_FEED
+#define __TOVE_GPUX_ATLAS_FEED 1
+
+#include "../common.h"
+#include "../graphics.h"
+#include "../shader/feed/color_feed.h"
+#include "geometry_feed.h"
+#include <memory>
+
+BEGIN_TOVE_NAMESPACE
+
+// packs the curve data and grid lists of all filled paths of a
+// Graphics into shared textures, so that the whole Graphics can be
+// drawn with one shader and one draw call. colors come from the
+// graphics' paint indices, i.e. are fed through a ColorFeed. strokes
+// are left out (see ToveGPUXAtlasData), so a stroke drawn over a fill
+// ends up above all of the atlas' fills.
+
+class GPUXAtlasFeed : public AbstractFeed {
+private:
+	struct Entry {
+		ToveShaderGeometryData geometry;
+		TovePaintData lineColor;
+		ToveBounds bounds;
+		ToveLookupTableMeta meta;
+		std::unique_ptr<GeometryFeed> feed;
+		int curvesRow;
+		int listsRow;
+	};
+
+	const GraphicsRef graphics;
+	const PaintIndicesRef paints;
+	std::vector<std::unique_ptr<Entry>> entries;
+
+	std::vector<float> header;
+	std::vector<uint8_t> lists;
+	std::vector<gpu_float_t> curves;
+	std::vector<uint8_t> vertices;
+
+	ToveGPUXAtlasData data;
+
+	void updateHeader(int i);
+	void updateVertices(int i);
+
+public:
+	GPUXAtlasFeed(const GraphicsRef &graphics);
+
+	virtual ToveChangeFlags beginUpdate();
+	virtual ToveChangeFlags endUpdate();
+
+	virtual ToveGPUXAtlasData *getAtlasData() {
+		return &data;
+	}
+
+	virtual void addMemoryUsage(ToveMemoryUsage &usage) const;
+};
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_GPUX_ATLAS_FEED
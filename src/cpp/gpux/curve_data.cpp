@@ -15,6 +15,22 @@
 
 BEGIN_TOVE_NAMESPACE
 
+inline void compareSwap(float &a, float &b) {
+	const float lo = std::min(a, b);
+	const float hi = std::max(a, b);
+	a = lo;
+	b = hi;
+}
+
+inline void sort4(float *v) {
+	// sorting network; compiles to min/max instructions, no branches.
+	compareSwap(v[0], v[1]);
+	compareSwap(v[2], v[3]);
+	compareSwap(v[0], v[2]);
+	compareSwap(v[1], v[3]);
+	compareSwap(v[1], v[2]);
+}
+
 void CurveData::storeRoots(gpu_float_t *out) const {
 	for (int i = 0; i < 4; i++) {
 		float t = bounds.sroots[i];
@@ -22,79 +38,170 @@ void CurveData::storeRoots(gpu_float_t *out) const {
 	}
 }
 
-void CurveBounds::update(const float *curve, float *bx, float *by) {
-	// adapted from nsvg__curveBounds.
+void CurveData::updateBatch(
+	CurveData *curves, const float *pts, const int n,
+	bool coefficients, bool bounds) {
 
-	const float *v0 = &curve[0];
-	const float *v1 = &curve[2];
-	const float *v2 = &curve[4];
-	const float *v3 = &curve[6];
-
-	// start the bounding box by end points
-	bounds[0] = std::min(v0[0], v3[0]);
-	bounds[1] = std::min(v0[1], v3[1]);
-	bounds[2] = std::max(v0[0], v3[0]);
-	bounds[3] = std::max(v0[1], v3[1]);
+	// computes bounds as nsvg__curveBounds does. processes curves in
+	// blocks of LANES, with all intermediate values stored as structure
+	// of arrays, so that the compiler can vectorize each of the inner
+	// loops. results agree with the scalar computation only up to
+	// rounding, as the compiler may reorder or fuse operations (e.g.
+	// under -ffast-math).
 
+	enum { LANES = 8 };
 	const float eps = 1e-12;
-	int totalcount = 0;
 
-	for (int i = 0; i < 2; i++) {
-		int count = 0;
-		Roots &r = roots[i];
+	for (int c0 = 0; c0 < n; c0 += LANES) {
+		const int m = std::min(int(LANES), n - c0);
+		const float *p = pts + c0 * 6;
 
-		float a = -3.0 * v0[i] + 9.0 * v1[i] - 9.0 * v2[i] + 3.0 * v3[i];
-		float b = 6.0 * v0[i] - 12.0 * v1[i] + 6.0 * v2[i];
-		float c = 3.0 * v1[i] - 3.0 * v0[i];
+		float v[2][4][LANES]; // control points per axis
+		for (int k = 0; k < 4; k++) {
+			for (int l = 0; l < LANES; l++) {
+				const int q = (l < m ? l : 0) * 6 + 2 * k;
+				v[0][k][l] = p[q + 0];
+				v[1][k][l] = p[q + 1];
+			}
+		}
 
-		if (fabs(a) < eps) {
-			if (fabs(b) > eps) {
-				double t = -c / b;
-				if (t > 0.0 && t < 1.0) {
-					r.t[count++] = t;
-				}
+		// detect lines, i.e. control points at 1/3 and 2/3 of the
+		// chord, up to float precision of the coordinates.
+		bool line[LANES];
+		for (int l = 0; l < LANES; l++) {
+			const float tolerance = 1e-5f * (1.0f +
+				std::abs(v[0][0][l]) + std::abs(v[1][0][l]) +
+				std::abs(v[0][3][l]) + std::abs(v[1][3][l]));
+			float error = 0.0f;
+			for (int i = 0; i < 2; i++) {
+				const float d = (v[i][3][l] - v[i][0][l]) / 3.0f;
+				const float e1 = v[i][1][l] - (v[i][0][l] + d);
+				const float e2 = v[i][2][l] - (v[i][3][l] - d);
+				error += e1 * e1 + e2 * e2;
 			}
-		} else {
-			double b2ac = b*b - 4.0*c*a;
-			if (b2ac > 0.0) {
-				double t = (-b + sqrt(b2ac)) / (2.0 * a);
-				if (t > 0.0 && t < 1.0) {
-					r.t[count++] = t;
-				}
-				t = (-b - sqrt(b2ac)) / (2.0 * a);
-				if (t > 0.0 && t < 1.0) {
-					r.t[count++] = t;
-				}
+			line[l] = error <= tolerance * tolerance;
+		}
+
+		float z[2][4][LANES]; // power coefficients per axis
+		for (int i = 0; i < 2; i++) {
+			for (int l = 0; l < LANES; l++) {
+				const float P0 = v[i][0][l];
+				const float P1 = v[i][1][l];
+				const float P2 = v[i][2][l];
+				const float P3 = v[i][3][l];
+				z[i][0][l] = line[l] ? 0.0f : -P0 + 3 * P1  + -3 * P2 + P3;
+				z[i][1][l] = line[l] ? 0.0f : 3 * P0 - 6 * P1 + 3 * P2;
+				z[i][2][l] = line[l] ? P3 - P0 : -3 * P0 + 3 * P1;
+				z[i][3][l] = P0;
 			}
 		}
 
-		for (int j = 0; j < count; j++) {
-			float t = r.t[j];
-			sroots[totalcount++] = t;
+		if (coefficients) {
+			for (int l = 0; l < m; l++) {
+				CurveData &c = curves[c0 + l];
+				for (int k = 0; k < 4; k++) {
+					c.bx[k] = z[0][k][l];
+					c.by[k] = z[1][k][l];
+				}
+				c.line = line[l];
+			}
+		}
 
-			float t2 = t * t;
-			float t3 = t2 * t;
+		if (!bounds) {
+			continue;
+		}
 
-			r.positions[2 * j + 0] =
-				bx[0] * t3 + bx[1] * t2 + bx[2] * t + bx[3];
-			r.positions[2 * j + 1] =
-				by[0] * t3 + by[1] * t2 + by[2] * t + by[3];
+		float lo[2][LANES], hi[2][LANES];
+		float t[2][2][LANES]; // roots per axis
+		int count[2][LANES];
+		float pos[2][2][2][LANES]; // positions per axis, root, coordinate
+		float s[4][LANES]; // sorted roots
+
+		for (int i = 0; i < 2; i++) {
+			for (int l = 0; l < LANES; l++) {
+				const float v0 = v[i][0][l];
+				const float v1 = v[i][1][l];
+				const float v2 = v[i][2][l];
+				const float v3 = v[i][3][l];
+
+				lo[i][l] = std::min(v0, v3);
+				hi[i][l] = std::max(v0, v3);
+
+				const float a = -3.0 * v0 + 9.0 * v1 - 9.0 * v2 + 3.0 * v3;
+				const float b = 6.0 * v0 - 12.0 * v1 + 6.0 * v2;
+				const float c = 3.0 * v1 - 3.0 * v0;
+
+				const bool linear = std::abs(a) < eps;
+				const double b2ac = b*b - 4.0*c*a;
+				const double sq = std::sqrt(std::max(b2ac, 0.0));
+
+				const double r0 = linear ? double(-c / b) : (-b + sq) / (2.0 * a);
+				const double r1 = (-b - sq) / (2.0 * a);
+
+				// lines are monotonic, i.e. have no inner extrema.
+				const bool ok0 = !line[l] &&
+					(linear ? std::abs(b) > eps : b2ac > 0.0) &&
+					r0 > 0.0 && r0 < 1.0;
+				const bool ok1 = !line[l] &&
+					!linear && b2ac > 0.0 && r1 > 0.0 && r1 < 1.0;
+
+				// compact valid roots to the front.
+				t[i][0][l] = ok0 ? float(r0) : float(r1);
+				t[i][1][l] = float(r1);
+				count[i][l] = int(ok0) + int(ok1);
+			}
+		}
 
-			const float v = r.positions[2 * j + i];
-			bounds[0 + i] = std::min(bounds[0 + i], v);
-			bounds[2 + i] = std::max(bounds[2 + i], v);
+		for (int i = 0; i < 2; i++) {
+			for (int j = 0; j < 2; j++) {
+				for (int l = 0; l < LANES; l++) {
+					const float tj = t[i][j][l];
+					const float t2 = tj * tj;
+					const float t3 = t2 * tj;
+					for (int d = 0; d < 2; d++) {
+						pos[i][j][d][l] = z[d][0][l] * t3 +
+							z[d][1][l] * t2 + z[d][2][l] * tj + z[d][3][l];
+					}
+
+					const bool valid = j < count[i][l];
+					const float w = pos[i][j][i][l];
+					lo[i][l] = valid ? std::min(lo[i][l], w) : lo[i][l];
+					hi[i][l] = valid ? std::max(hi[i][l], w) : hi[i][l];
+					s[2 * i + j][l] = valid ? tj : 1.0f;
+				}
+			}
 		}
 
-		r.count = count;
-	}
+		for (int l = 0; l < LANES; l++) {
+			float r[4] = {s[0][l], s[1][l], s[2][l], s[3][l]};
+			sort4(r);
+			for (int k = 0; k < 4; k++) {
+				s[k][l] = r[k];
+			}
+		}
 
-	// sort roots
+		for (int l = 0; l < m; l++) {
+			CurveBounds &cb = curves[c0 + l].bounds;
+
+			cb.bounds[0] = lo[0][l];
+			cb.bounds[1] = lo[1][l];
+			cb.bounds[2] = hi[0][l];
+			cb.bounds[3] = hi[1][l];
+
+			for (int i = 0; i < 2; i++) {
+				CurveBounds::Roots &r = cb.roots[i];
+				r.count = count[i][l];
+				for (int j = 0; j < 2; j++) {
+					r.t[j] = t[i][j][l];
+					r.positions[2 * j + 0] = pos[i][j][0][l];
+					r.positions[2 * j + 1] = pos[i][j][1][l];
+				}
+			}
 
-	if (totalcount > 1) {
-		std::sort(sroots, sroots + totalcount);
-	}
-	for (int i = totalcount; i < 4; i++) {
-		sroots[i] = 1.0f;
+			for (int k = 0; k < 4; k++) {
+				cb.sroots[k] = s[k][l];
+			}
+		}
 	}
 }
 
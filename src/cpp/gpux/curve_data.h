@@ -32,8 +32,6 @@ struct CurveBounds {
 	float bounds[4];
 	Roots roots[2];
 	float sroots[4];
-
-	void update(const float *curve, float *bx, float *by);
 };
 
 template<typename T>
@@ -50,15 +48,25 @@ public:
 	coeff by[4];
 	CurveBounds bounds;
 
+	// true if this curve is a straight line with control points at 1/3
+	// and 2/3 (as written by lineTo). bx and by then hold the exact linear
+	// coefficients, i.e. bx[0] = bx[1] = by[0] = by[1] = 0, and bounds has
+	// no roots.
+	bool line;
+
 	inline void updatePCs(const float *pts) {
-		bezierpc(pts[0], pts[2], pts[4], pts[6], bx);
-		bezierpc(pts[1], pts[3], pts[5], pts[7], by);
+		updateBatch(this, pts, 1, true, false);
 	}
 
 	inline void updateBounds(const float *pts) {
-		bounds.update(pts, bx, by);
+		updateBatch(this, pts, 1, false, true);
 	}
 
+	// updates coefficients (including line) and/or bounds of n
+	// consecutive curves sharing end points (i.e. as in nsvg.pts).
+	static void updateBatch(CurveData *curves, const float *pts, int n,
+		bool coefficients, bool bounds);
+
 	void storeRoots(gpu_float_t *out) const;
 };
 
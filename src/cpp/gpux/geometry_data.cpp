@@ -14,6 +14,8 @@
 #include "../utils.h"
 #include <memory.h>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 BEGIN_TOVE_NAMESPACE
 
@@ -21,7 +23,9 @@ GeometryData::GeometryData(
 	int maxCurves,
 	int maxSubPaths,
 	bool fragmentShaderStrokes,
-	ToveShaderGeometryData &data) : data(data) {
+	ToveShaderGeometryData &data,
+	bool grid,
+	bool wideLists) : data(data) {
 
 	std::memset(&data, 0, sizeof(ToveShaderGeometryData));
 
@@ -55,16 +59,33 @@ GeometryData::GeometryData(
 	// lists texture size: per axis, we can have up to 2 entries per
 	// curve.
 
+	// for more than 253 curves, we store each curve index as two
+	// bytes, i.e. one rgba8 texel holds two indices instead of four.
+	// wideLists forces this, e.g. for paths sharing one atlas.
+
     data.listsTexture = nullptr;
+	data.listsIndexSize = (wideLists || maxCurves > MAX_GPUX_CURVES_8BIT) ? 2 : 1;
+	int numMarkers = fragmentShaderStrokes ? 2 : 1;
+	if (grid) {
+		numMarkers += 1; // ray direction of each cell
+	}
+	const int numEntries = (maxCurves + numMarkers) * data.listsIndexSize;
+    data.listsTextureSize[0] = div4(numEntries);
 	if (fragmentShaderStrokes) {
-	    data.listsTextureSize[0] = div4(maxCurves + 2); // two markers
 	    data.listsTextureSize[1] = 2 * (maxCurves * 2 + 2);
 	} else {
-		data.listsTextureSize[0] = div4(maxCurves + 1); // one marker
 	    data.listsTextureSize[1] = 2 * (maxCurves * 2);
 	}
     data.listsTextureFormat = "rgba8";
 
+	// in grid mode, each cell's curve list occupies one row of the
+	// lists texture; we choose a grid size that fits into it.
+	data.gridSize = 0;
+	if (grid) {
+		data.gridSize = std::max(1, std::min(int(MAX_GPUX_GRID_SIZE),
+			int(std::sqrt(float(data.listsTextureSize[1])))));
+	}
+
     data.curvesTexture = nullptr;
 #if 1
 	// for some reason, using a texture width of 12 for the "curves"
@@ -108,6 +129,42 @@ GeometryData::~GeometryData() {
 	delete[] data.lineRuns;
 }
 
+void addGeometryMemoryUsage(
+	const ToveShaderGeometryData &data,
+	ToveMemoryUsage &usage) {
+
+	double bytes = 0;
+
+	if (data.bounds) {
+		bytes += sizeof(ToveBounds);
+	}
+	for (int i = 0; i < 2; i++) {
+		if (data.lookupTable[i]) {
+			bytes += data.lookupTableSize * sizeof(float);
+		}
+	}
+	if (data.lookupTableMeta) {
+		bytes += sizeof(ToveLookupTableMeta);
+	}
+
+	// band meshes have 4 floats per vertex, except for the unsafe
+	// y bands, which only have (x, y).
+	for (int i = 0; i < 3; i++) {
+		if (data.bandsVertices[i]) {
+			bytes += data.maxBandsVertices * (i == 1 ? 2 : 4) * sizeof(float);
+		}
+	}
+
+	if (data.listsTexture) {
+		bytes += data.listsTextureRowBytes * data.listsTextureSize[1];
+	}
+	if (data.curvesTexture) {
+		bytes += data.curvesTextureRowBytes * data.curvesTextureSize[1];
+	}
+
+	usage.geometry += bytes;
+}
+
 GeometryNoLinkData::GeometryNoLinkData(
 	int maxCurves, int maxSubPaths,
 	bool fragmentShaderStrokes, ToveShaderGeometryData &data) :
@@ -17,6 +17,20 @@
 
 BEGIN_TOVE_NAMESPACE
 
+enum {
+	// up to this number of curves, curve lists use 8-bit indices;
+	// beyond that, we switch to 16-bit indices.
+	MAX_GPUX_CURVES_8BIT = 253,
+
+	// the shader might decode curve indices as fp16, which represents
+	// integers exactly only up to 2048; band mode breaks down badly if
+	// indices get rounded, so this holds for bands and grids alike.
+	MAX_GPUX_CURVES = 2048,
+
+	// maximum number of grid cells per axis for TOVE_GPUX_GRID.
+	MAX_GPUX_GRID_SIZE = 16
+};
+
 class GeometryData {
 protected:
 	ToveShaderGeometryData &data;
@@ -26,10 +40,18 @@ public:
 		int maxCurves,
 		int maxSubPaths,
 		bool fragmentShaderStrokes,
-		ToveShaderGeometryData &data);
+		ToveShaderGeometryData &data,
+		bool grid = false,
+		bool wideLists = false);
 	~GeometryData();
 };
 
+// the textures, lookup tables and band meshes data points to, no
+// matter if LÖVE or a GeometryNoLinkData allocated them.
+void addGeometryMemoryUsage(
+	const ToveShaderGeometryData &data,
+	ToveMemoryUsage &usage);
+
 struct GeometryNoLinkData : public GeometryData {
 	GeometryNoLinkData(
 		int maxCurves,
@@ -14,7 +14,12 @@
 #include "../utils.h"
 #include "../subpath.h"
 #include "../path.h"
+#include "../stats.h"
+#include "../footprint.h"
 #include <algorithm>
+#include <sstream>
+#include <limits>
+#include <cstring>
 
 BEGIN_TOVE_NAMESPACE
 
@@ -72,7 +77,7 @@ static void queryLUT(
 		lo -= 1;
 	}
 
-	const uint8_t *base = data->listsTexture;
+	uint8_t *base = data->listsTexture;
 	const int rowBytes = data->listsTextureRowBytes;
 	base += dim * rowBytes * (data->listsTextureSize[1] / 2);
 
@@ -81,108 +86,159 @@ static void queryLUT(
 			break;
 		}
 
-		const uint8_t *list = base + rowBytes * i;
-		while (*list != SENTINEL_END) {
-			result.insert(*list++);
+		CurveList list(base + rowBytes * i, data->listsIndexSize > 1);
+		int curve;
+		while (list.next(curve)) {
+			result.insert(curve);
 		}
 	}
 }
 
-int GeometryFeed::buildLUT(int dim, const int ncurves) {
+void GeometryFeed::addCurveEvents(
+	const int dim, const int i, Event *&e, Event *&se) const {
+
 	const bool hasFragLine = geometryData.fragmentShaderLine;
 	const float lineWidth = geometryData.strokeWidth;
+	const int dimtwo = 1 - dim;
 
-	auto e = fillEvents.begin();
-	auto se = strokeEvents.begin();
+	const ExCurveData &ext = extended[i];
 
-	{
-		const int n = ncurves;
-		const int dimtwo = 1 - dim;
+	if (ext.ignore & IGNORE_FILL) {
+		return;
+	}
 
-		assert(fillEvents.size() >= n * 6);
-		assert(strokeEvents.size() >= n * 2);
+	const CurveBounds *bounds = ext.bounds;
 
-		for (int i = 0; i < n; i++) {
-			const ExCurveData &ext = extended[i];
+	const float x0 = bounds->bounds[dimtwo + 0];
+	const float y0 = bounds->bounds[dim + 0];
+	const float x1 = bounds->bounds[dimtwo + 2];
+	const float y1 = bounds->bounds[dim + 2];
 
-			if (ext.ignore & IGNORE_FILL) {
-				continue;
-			}
+	if (y0 == y1 && x0 == x1) {
+		return;
+	}
 
-			const CurveBounds *bounds = ext.bounds;
+	e->y = y0;
+	e->t = EVENT_ENTER;
+	e->curve = i;
+	e++;
 
-			const float x0 = bounds->bounds[dimtwo + 0];
-			const float y0 = bounds->bounds[dim + 0];
-			const float x1 = bounds->bounds[dimtwo + 2];
-			const float y1 = bounds->bounds[dim + 2];
+	e->y = y1;
+	e->t = EVENT_EXIT;
+	e->curve = i;
+	e++;
 
-			if (y0 == y1 && x0 == x1) {
-				continue;
-			}
+	e->y = ext.endpoints.p1[dim];
+	e->t = EVENT_MARK;
+	e->curve = i;
+	e++;
+
+	e->y = ext.endpoints.p2[dim];
+	e->t = EVENT_MARK;
+	e->curve = i;
+	e++;
 
-			e->y = y0;
-			e->t = EVENT_ENTER;
-			e->curve = i;
-			e++;
+	if (hasFragLine) {
+		se->y = y0 - lineWidth;
+		se->t = EVENT_ENTER;
+		se->curve = i;
+		se++;
+
+		se->y = y1 + lineWidth;
+		se->t = EVENT_EXIT;
+		se->curve = i;
+		se++;
+	}
 
-			e->y = y1;
-			e->t = EVENT_EXIT;
-			e->curve = i;
-			e++;
+	const CurveBounds::Roots &r = bounds->roots[dim];
+	for (int j = 0; j < r.count; j++) {
+		e->y = r.positions[2 * j + dim];
+		e->t = EVENT_MARK;
+		e->curve = i;
+		e++;
+	}
+}
 
-			e->y = ext.endpoints.p1[dim];
-			e->t = EVENT_MARK;
-			e->curve = i;
-			e++;
+int GeometryFeed::buildLUT(int dim, const int ncurves, bool incremental) {
+	TOVE_TRACE_ZONE("gpux.lut");
+	stats::count(stats::LUT_REBUILDS);
 
-			e->y = ext.endpoints.p2[dim];
-			e->t = EVENT_MARK;
-			e->curve = i;
-			e++;
+	const bool hasFragLine = geometryData.fragmentShaderLine;
+	const float lineWidth = geometryData.strokeWidth;
 
-			if (hasFragLine) {
-				se->y = y0 - lineWidth;
-				se->t = EVENT_ENTER;
-				se->curve = i;
-				se++;
-
-				se->y = y1 + lineWidth;
-				se->t = EVENT_EXIT;
-				se->curve = i;
-				se++;
-			}
+	std::vector<Event> &fillEvents = this->fillEvents[dim];
+	std::vector<Event> &strokeEvents = this->strokeEvents[dim];
 
-			const CurveBounds::Roots &r = bounds->roots[dim];
-			for (int j = 0; j < r.count; j++) {
-				e->y = r.positions[2 * j + dim];
-				e->t = EVENT_MARK;
-				e->curve = i;
-				e++;
+	assert(fillEvents.size() >= ncurves * 6);
+	assert(strokeEvents.size() >= ncurves * 2);
+
+	const auto byY = [] (const Event &a, const Event &b) {
+		return a.y < b.y;
+	};
+
+	if (incremental) {
+		// only events of changed curves get removed and reinserted;
+		// all other events are still sorted from the last update.
+
+		const auto isDirty = [this] (const Event &e) {
+			return dirtyCurves[e.curve] != 0;
+		};
+
+		const int fill0 = std::remove_if(fillEvents.begin(),
+			fillEvents.begin() + numFillEvents[dim], isDirty) - fillEvents.begin();
+		const int stroke0 = std::remove_if(strokeEvents.begin(),
+			strokeEvents.begin() + numStrokeEvents[dim], isDirty) - strokeEvents.begin();
+
+		Event *e = fillEvents.data() + fill0;
+		Event *se = strokeEvents.data() + stroke0;
+
+		for (int i = 0; i < ncurves; i++) {
+			if (dirtyCurves[i]) {
+				addCurveEvents(dim, i, e, se);
 			}
 		}
 
-		assert(e <= fillEvents.end());
-		assert(se <= strokeEvents.end());
-	}
+		const int fill1 = e - fillEvents.data();
+		std::sort(fillEvents.begin() + fill0, fillEvents.begin() + fill1, byY);
+		std::inplace_merge(fillEvents.begin(),
+			fillEvents.begin() + fill0, fillEvents.begin() + fill1, byY);
+		numFillEvents[dim] = fill1;
+
+		const int stroke1 = se - strokeEvents.data();
+		if (hasFragLine) {
+			std::sort(strokeEvents.begin() + stroke0, strokeEvents.begin() + stroke1, byY);
+			std::inplace_merge(strokeEvents.begin(),
+				strokeEvents.begin() + stroke0, strokeEvents.begin() + stroke1, byY);
+		}
+		numStrokeEvents[dim] = stroke1;
+	} else {
+		Event *e = fillEvents.data();
+		Event *se = strokeEvents.data();
 
-	const int numFillEvents = e - fillEvents.begin();
-	const int numLineEvents = se - strokeEvents.begin();
+		for (int i = 0; i < ncurves; i++) {
+			addCurveEvents(dim, i, e, se);
+		}
 
-	std::sort(fillEvents.begin(), fillEvents.begin() + numFillEvents,
-		[] (const Event &a, const Event &b) {
-			return a.y < b.y;
-		});
+		numFillEvents[dim] = e - fillEvents.data();
+		numStrokeEvents[dim] = se - strokeEvents.data();
 
-	if (hasFragLine) {
-		std::sort(strokeEvents.begin(), strokeEvents.begin() + numLineEvents,
-			[] (const Event &a, const Event &b) {
-				return a.y < b.y;
-			});
+		std::sort(fillEvents.begin(),
+			fillEvents.begin() + numFillEvents[dim], byY);
+
+		if (hasFragLine) {
+			std::sort(strokeEvents.begin(),
+				strokeEvents.begin() + numStrokeEvents[dim], byY);
+		}
+	}
 
+	const int numFillEvents = this->numFillEvents[dim];
+	const int numLineEvents = this->numStrokeEvents[dim];
+
+	if (hasFragLine) {
 		strokeEventsLUT.build(dim, strokeEvents, numLineEvents, extended);
 
 		fillEventsLUT.build(dim, fillEvents, numFillEvents, extended, lineWidth,
-			[this, dim] (float y0, float y1, const CurveSet &active, uint8_t *list, int z) {
+			[this, dim] (float y0, float y1, const CurveSet &active, CurveList &list, int z) {
 				strokeCurves.clear();
 				queryLUT(&strokeShaderData, dim, y0, y1, strokeCurves);
 
@@ -190,10 +246,10 @@ int GeometryFeed::buildLUT(int dim, const int ncurves) {
 				for (const auto curveIndex : strokeCurves) {
 					if (active.find(curveIndex) == active.end()) {
 						if (!hasStrokeSentinel) {
-							*list++ = SENTINEL_STROKES;
+							list.addStrokesMarker();
 							hasStrokeSentinel = true;
 						}
-						*list++ = curveIndex;
+						list.add(curveIndex);
 					}
 				}
 
@@ -220,15 +276,15 @@ int GeometryFeed::buildLUT(int dim, const int ncurves) {
 					if (active.find(curveIndex) == active.end() &&
 						strokeCurves.find(curveIndex) == strokeCurves.end()) {
 						if (!hasStrokeSentinel) {
-							*list++ = SENTINEL_STROKES;
+							list.addStrokesMarker();
 							hasStrokeSentinel = true;
 						}
-						*list++ = curveIndex;
+						list.add(curveIndex);
 					}
 				}
 #endif
 
-				*list = SENTINEL_END;
+				list.end();
 			});
 	} else {
 		fillEventsLUT.build(dim, fillEvents, numFillEvents, extended);
@@ -237,6 +293,133 @@ int GeometryFeed::buildLUT(int dim, const int ncurves) {
 	return numFillEvents;
 }
 
+inline bool isPointCurve(const CurveBounds *bounds) {
+	const float *b = bounds->bounds;
+	return b[0] == b[2] && b[1] == b[3];
+}
+
+bool GeometryFeed::computeGridBounds(const int ncurves) {
+	float *bounds = geometryData.bounds->bounds;
+	bool found = false;
+
+	for (int i = 0; i < ncurves; i++) {
+		const ExCurveData &ext = extended[i];
+		if ((ext.ignore & IGNORE_FILL) || isPointCurve(ext.bounds)) {
+			continue;
+		}
+
+		const float *b = ext.bounds->bounds;
+		if (!found) {
+			std::memcpy(bounds, b, 4 * sizeof(float));
+			found = true;
+		} else {
+			bounds[0] = std::min(bounds[0], b[0]);
+			bounds[1] = std::min(bounds[1], b[1]);
+			bounds[2] = std::max(bounds[2], b[2]);
+			bounds[3] = std::max(bounds[3], b[3]);
+		}
+	}
+
+	return found;
+}
+
+void GeometryFeed::buildGrid(const int ncurves) {
+	TOVE_TRACE_ZONE("gpux.grid");
+	stats::count(stats::LUT_REBUILDS);
+
+	// for each cell, we pick the ray direction (+x, -x, +y, -y) that
+	// crosses the fewest curves and store it as first list entry,
+	// followed by all curves that such a ray might hit. lists for
+	// outer cells extend to infinity, so that positions outside the
+	// grid bounds still get correct (if longer) lists.
+
+	const int size = geometryData.gridSize;
+	const float *bounds = geometryData.bounds->bounds;
+	const float cellW = (bounds[2] - bounds[0]) / size;
+	const float cellH = (bounds[3] - bounds[1]) / size;
+	const float inf = std::numeric_limits<float>::infinity();
+
+	const bool hasFragLine = geometryData.fragmentShaderLine;
+	const float lineWidth = geometryData.strokeWidth;
+	const bool wide = geometryData.listsIndexSize > 1;
+	const int rowBytes = geometryData.listsTextureRowBytes;
+
+	for (int cy = 0; cy < size; cy++) {
+		const float y0 = cy > 0 ? bounds[1] + cy * cellH : -inf;
+		const float y1 = cy < size - 1 ? bounds[1] + (cy + 1) * cellH : inf;
+
+		for (int cx = 0; cx < size; cx++) {
+			const float x0 = cx > 0 ? bounds[0] + cx * cellW : -inf;
+			const float x1 = cx < size - 1 ? bounds[0] + (cx + 1) * cellW : inf;
+
+			const auto hits = [x0, y0, x1, y1] (const float *b, int direction) {
+				switch (direction) {
+					case 0: return b[1] <= y1 && b[3] >= y0 && b[2] >= x0;
+					case 1: return b[1] <= y1 && b[3] >= y0 && b[0] <= x1;
+					case 2: return b[0] <= x1 && b[2] >= x0 && b[3] >= y0;
+					default: return b[0] <= x1 && b[2] >= x0 && b[1] <= y1;
+				}
+			};
+
+			int count[4] = {0, 0, 0, 0};
+			for (int i = 0; i < ncurves; i++) {
+				const ExCurveData &ext = extended[i];
+				if ((ext.ignore & IGNORE_FILL) || isPointCurve(ext.bounds)) {
+					continue;
+				}
+				for (int d = 0; d < 4; d++) {
+					count[d] += hits(ext.bounds->bounds, d) ? 1 : 0;
+				}
+			}
+
+			const int direction = std::min_element(count, count + 4) - count;
+
+			CurveList list(geometryData.listsTexture +
+				rowBytes * (cy * size + cx), wide);
+			list.add(direction);
+
+			for (int i = 0; i < ncurves; i++) {
+				const ExCurveData &ext = extended[i];
+				if ((ext.ignore & IGNORE_FILL) || isPointCurve(ext.bounds)) {
+					continue;
+				}
+				if (hits(ext.bounds->bounds, direction)) {
+					list.add(i);
+				}
+			}
+
+			if (hasFragLine) {
+				bool hasStrokeSentinel = false;
+				for (int i = 0; i < ncurves; i++) {
+					const ExCurveData &ext = extended[i];
+					if ((ext.ignore & IGNORE_LINE) || isPointCurve(ext.bounds)) {
+						continue;
+					}
+					const float *b = ext.bounds->bounds;
+					if (hits(b, direction)) {
+						continue; // already in list.
+					}
+					if (b[0] - lineWidth <= x1 && b[2] + lineWidth >= x0 &&
+						b[1] - lineWidth <= y1 && b[3] + lineWidth >= y0) {
+						if (!hasStrokeSentinel) {
+							list.addStrokesMarker();
+							hasStrokeSentinel = true;
+						}
+						list.add(i);
+					}
+				}
+			}
+
+			list.end();
+		}
+	}
+
+	ToveLookupTableMeta *meta = geometryData.lookupTableMeta;
+	meta->n[0] = size;
+	meta->n[1] = size;
+	meta->bsearch = 0;
+}
+
 #if TOVE_GPUX_MESH_BAND
 int GeometryFeed::computeYBands() {
 	float last_y1;
@@ -407,14 +590,23 @@ void GeometryFeed::dumpCurveData() {
 #endif
 }
 
+// the number of curves we allocate for; 0 if the path exceeds what
+// our data layout supports, in which case the feed stays empty.
+static int supportedCurves(const PathRef &path) {
+	const int n = path->getNumCurves();
+	return n > MAX_GPUX_CURVES ? 0 : n;
+}
+
 GeometryFeed::GeometryFeed(
 	const PathRef &path,
 	ToveShaderGeometryData &data,
 	const TovePaintData &lineColorData,
-	bool enableFragmentShaderStrokes) :
+	bool enableFragmentShaderStrokes,
+	ToveGPUXAcceleration acceleration,
+	bool wideLists) :
 
 	path(path),
-	maxCurves(path->getNumCurves()),
+	maxCurves(supportedCurves(path)),
 	maxSubPaths(path->getNumSubpaths()),
 	geometryData(data),
 	lineColorData(lineColorData),
@@ -422,19 +614,28 @@ GeometryFeed::GeometryFeed(
 	strokeEventsLUT(maxCurves, strokeShaderData, IGNORE_LINE),
 	strokeCurves(4),
 	allocData(maxCurves, maxSubPaths,
-		enableFragmentShaderStrokes && path->hasStroke(), geometryData),
+		enableFragmentShaderStrokes && path->hasStroke(), geometryData,
+		acceleration == TOVE_GPUX_GRID, wideLists),
 	allocStrokeData(maxCurves, maxSubPaths, true, strokeShaderData),
 	enableFragmentShaderStrokes(enableFragmentShaderStrokes) {
 
-	if (maxCurves < 1) {
+	if (path->getNumCurves() > MAX_GPUX_CURVES) {
+		std::ostringstream s;
+		s << "path too complex; only up to " << MAX_GPUX_CURVES <<
+			" curves. path will not be rendered.";
+		tove::report::err(s.str().c_str());
+	} else if (maxCurves < 1) {
 		tove::report::warn("cannot render empty paths.");
-	} else if (maxCurves > 253) {
-		tove::report::warn("path too complex; only up to 253 curves.");
 	}
 
-	fillEvents.resize(6 * maxCurves);
-	strokeEvents.resize(2 * maxCurves);
+	for (int dim = 0; dim < 2; dim++) {
+		fillEvents[dim].resize(6 * maxCurves);
+		strokeEvents[dim].resize(2 * maxCurves);
+		numFillEvents[dim] = 0;
+		numStrokeEvents[dim] = 0;
+	}
 	extended.resize(maxCurves);
+	dirtyCurves.resize(maxCurves);
 #if TOVE_GPUX_MESH_BAND
 	bands.resize(geometryData.lookupTableSize);
 #endif
@@ -444,11 +645,58 @@ GeometryFeed::GeometryFeed(
 }
 
 GeometryFeed::~GeometryFeed() {
+	unobserveSubpaths();
 	path->removeObserver(this);	
 }
 
- void GeometryFeed::observableChanged(Observable *observable, ToveChangeFlags what) {
-	changes |= what;
+void GeometryFeed::addMemoryUsage(ToveMemoryUsage &usage) const {
+	for (int dim = 0; dim < 2; dim++) {
+		footprint::add(usage.geometry, usage, fillEvents[dim]);
+		footprint::add(usage.geometry, usage, strokeEvents[dim]);
+	}
+	footprint::add(usage.geometry, usage, extended);
+	footprint::add(usage.geometry, usage, subpaths);
+	footprint::add(usage.geometry, usage, subpathCurves);
+	footprint::add(usage.geometry, usage, dirtyCurves);
+#if TOVE_GPUX_MESH_BAND
+	footprint::add(usage.geometry, usage, bands);
+#endif
+
+	if (geometryData.lineRuns) {
+		usage.geometry += maxSubPaths * sizeof(ToveLineRun);
+	}
+	addGeometryMemoryUsage(strokeShaderData, usage);
+}
+
+void GeometryFeed::observeSubpaths() {
+	unobserveSubpaths();
+
+	const int n = path->getNumSubpaths();
+	subpaths.reserve(n);
+	subpathCurves.reserve(n);
+	for (int i = 0; i < n; i++) {
+		const SubpathRef subpath = path->getSubpath(i);
+		subpath->addObserver(this);
+		subpaths.push_back(subpath);
+		subpathCurves.push_back(subpath->getNumCurves(false));
+	}
+}
+
+void GeometryFeed::unobserveSubpaths() {
+	for (const SubpathRef &subpath : subpaths) {
+		subpath->removeObserver(this);
+	}
+	subpaths.clear();
+	subpathCurves.clear();
+	changedSubpaths.clear();
+}
+
+void GeometryFeed::observableChanged(Observable *observable, ToveChangeFlags what) {
+	if (observable == path.get()) {
+		changes |= what;
+	} else {
+		changedSubpaths.insert(observable);
+	}
 }
 
 ToveChangeFlags GeometryFeed::beginUpdate() {
@@ -493,11 +741,17 @@ ToveChangeFlags GeometryFeed::endUpdate() {
 		return 0;
 	}
 
+	if (path->getNumCurves() > maxCurves) {
+		// too complex (see supportedCurves); keep numCurves at 0.
+		changes = 0;
+		return 0;
+	}
+
 #if TOVE_DEBUG
 	assert(path->getNumCurves() <= maxCurves);
 
-	assert(geometryData.lookupTable[0] != nullptr);
-	assert(geometryData.lookupTable[1] != nullptr);
+	assert(geometryData.gridSize > 0 || geometryData.lookupTable[0] != nullptr);
+	assert(geometryData.gridSize > 0 || geometryData.lookupTable[1] != nullptr);
 	assert(geometryData.lookupTableMeta != nullptr);
 
 	assert(geometryData.listsTexture != nullptr);
@@ -510,16 +764,29 @@ ToveChangeFlags GeometryFeed::endUpdate() {
 	assert(geometryData.curvesTextureSize[1] == maxCurves);
 #endif
 
-	// build curve data
+	// build curve data. if only some subpaths changed, we recompute
+	// only their curves and update the LUTs incrementally.
 
 	int numSubpaths = path->getNumSubpaths();
 	assert(numSubpaths <= maxSubPaths);
 
+	bool incremental = (changes & (CHANGED_LINE_ARGS | CHANGED_INITIAL)) == 0 &&
+		int(subpaths.size()) == numSubpaths;
+	for (int i = 0; incremental && i < numSubpaths; i++) {
+		const SubpathRef &t = subpaths[i];
+		incremental = t == path->getSubpath(i) &&
+			subpathCurves[i] == t->getNumCurves(false);
+	}
+	if (!incremental) {
+		observeSubpaths();
+	}
+
 	ToveLineRun *lineRuns = geometryData.lineRuns;
 
 	int curveIndex = 0;
+	bool anyDirty = false;
 	for (int i = 0; i < numSubpaths; i++) {
-		const SubpathRef t = path->getSubpath(i);
+		const SubpathRef &t = subpaths[i];
 		const int n = t->getNumCurves(false);
 
 		if (lineRuns) {
@@ -529,9 +796,12 @@ ToveChangeFlags GeometryFeed::endUpdate() {
 			lineRuns++;
 		}
 
-		if (true) { // FIXME: check for subpath changes
-			for (int j = 0; j < n; j++) {
-				assert(curveIndex < maxCurves);
+		const bool dirty = !incremental ||
+			changedSubpaths.find(t.get()) != changedSubpaths.end();
+
+		for (int j = 0; j < n; j++) {
+			assert(curveIndex < maxCurves);
+			if (dirty) {
 				if (t->computeShaderCurveData(
 					&geometryData, j, curveIndex, extended[curveIndex])) {
 
@@ -539,16 +809,17 @@ ToveChangeFlags GeometryFeed::endUpdate() {
 				} else {
 					extended[curveIndex].ignore = IGNORE_FILL | IGNORE_LINE;
 				}
-				curveIndex++;
 			}
-		} else {
-			assert(false); // not implemented yet
-			//curveIndex += t->getNumCurves();
+			dirtyCurves[curveIndex] = dirty;
+			curveIndex++;
 		}
+
+		anyDirty = anyDirty || (dirty && n > 0);
 	}
 	assert(curveIndex <= maxCurves);
 	geometryData.numCurves = curveIndex;
 	geometryData.numSubPaths = numSubpaths;
+	changedSubpaths.clear();
 
 #if 0
 	if (initial) {
@@ -556,18 +827,34 @@ ToveChangeFlags GeometryFeed::endUpdate() {
 	}
 #endif
 
-	float *bounds = geometryData.bounds->bounds;
+	if (incremental && !anyDirty) {
+		// nothing changed that affects the LUTs.
+		const ToveChangeFlags returnedChanges = changes;
+		changes = 0;
+		return returnedChanges;
+	}
 
-	for (int dim = 0; dim < 2; dim++) {
-		int numEvents = buildLUT(dim, curveIndex);
+	float *bounds = geometryData.bounds->bounds;
+	const bool grid = geometryData.gridSize > 0;
 
-		if (numEvents > 0) {
-			bounds[dim + 0] = fillEvents[0].y;
-			bounds[dim + 2] = fillEvents[numEvents - 1].y;
-		} else {
+	if (grid) {
+		if (!computeGridBounds(curveIndex)) {
 			// all curves are points.
-			bounds[dim + 0] = 0.0f;
-			bounds[dim + 2] = 0.0f;
+			std::memset(bounds, 0, 4 * sizeof(float));
+		}
+	} else {
+		for (int dim = 0; dim < 2; dim++) {
+			const int numEvents = buildLUT(dim, curveIndex, incremental);
+			const std::vector<Event> &fillEvents = this->fillEvents[dim];
+
+			if (numEvents > 0) {
+				bounds[dim + 0] = fillEvents[0].y;
+				bounds[dim + 2] = fillEvents[numEvents - 1].y;
+			} else {
+				// all curves are points.
+				bounds[dim + 0] = 0.0f;
+				bounds[dim + 2] = 0.0f;
+			}
 		}
 	}
 
@@ -593,7 +880,12 @@ ToveChangeFlags GeometryFeed::endUpdate() {
 	}
 #endif
 
-	updateLookupTableMeta(geometryData.lookupTableMeta);
+	if (grid) {
+		// the grid needs the final (i.e. line width padded) bounds.
+		buildGrid(curveIndex);
+	} else {
+		updateLookupTableMeta(geometryData.lookupTableMeta);
+	}
 
 	const ToveChangeFlags returnedChanges = changes;
 	changes = 0;
@@ -9,6 +9,9 @@
  * All rights reserved.
  */
 
+#ifndef __TOVE_GEOMETRY_FEED
+#define __TOVE_GEOMETRY_FEED 1
+
 #include <vector>
 #include "../common.h"
 #include "../observer.h"
@@ -22,15 +25,18 @@ private:
 	const PathRef path;
 	ToveChangeFlags changes;
 
-	const int maxCurves;
+	const int maxCurves; // 0 if the path has too many curves
 	const int maxSubPaths;
 
 	ToveShaderGeometryData &geometryData;
 	const TovePaintData &lineColorData;
 	ToveShaderGeometryData strokeShaderData;
 
-    std::vector<Event> fillEvents;
-    std::vector<Event> strokeEvents;
+    // sorted events per axis, kept between updates.
+    std::vector<Event> fillEvents[2];
+    std::vector<Event> strokeEvents[2];
+    int numFillEvents[2];
+    int numStrokeEvents[2];
     LookupTable fillEventsLUT;
     LookupTable strokeEventsLUT;
     LookupTable::CurveSet strokeCurves;
@@ -40,7 +46,21 @@ private:
 	GeometryNoLinkData allocStrokeData;
 	const bool enableFragmentShaderStrokes;
 
-	int buildLUT(int dim, const int ncurves);
+	// subpaths we observe for incremental updates, their curve
+	// counts, and which of them changed since the last update.
+	std::vector<SubpathRef> subpaths;
+	std::vector<int> subpathCurves;
+	tsl::robin_set<const Observable*> changedSubpaths;
+	std::vector<uint8_t> dirtyCurves;
+
+	void observeSubpaths();
+	void unobserveSubpaths();
+
+	void addCurveEvents(const int dim, const int i, Event *&e, Event *&se) const;
+	int buildLUT(int dim, const int ncurves, bool incremental);
+
+	bool computeGridBounds(const int ncurves);
+	void buildGrid(const int ncurves);
 
 #if TOVE_GPUX_MESH_BAND
 	struct Band {
@@ -64,13 +84,21 @@ public:
 		const PathRef &path,
 		ToveShaderGeometryData &data,
 		const TovePaintData &lineColorData,
-		bool enableFragmentShaderStrokes);
+		bool enableFragmentShaderStrokes,
+		ToveGPUXAcceleration acceleration = TOVE_GPUX_BANDS,
+		bool wideLists = false);
 	virtual ~GeometryFeed();
 
 	ToveChangeFlags beginUpdate();
     ToveChangeFlags endUpdate();
 
+	// covers what this feed allocated itself, but not the textures of
+	// the ToveShaderGeometryData it feeds (see addGeometryMemoryUsage).
+	void addMemoryUsage(ToveMemoryUsage &usage) const;
+
 	virtual void observableChanged(Observable *observable, ToveChangeFlags what);
 };
 
 END_TOVE_NAMESPACE
+
+#endif // __TOVE_GEOMETRY_FEED
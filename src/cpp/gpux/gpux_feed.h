@@ -25,10 +25,15 @@ private:
 	GeometryFeed geometry;
 
 public:
-	inline GPUXFeed(const PathRef &path, bool enableFragmentShaderStrokes) :
+	inline GPUXFeed(
+		const PathRef &path,
+		bool enableFragmentShaderStrokes,
+		ToveGPUXAcceleration acceleration = TOVE_GPUX_BANDS) :
+
 		lineColor(path, data.color.line, 1),
 		fillColor(path, data.color.fill, 1),
-		geometry(path, data.geometry, data.color.line, enableFragmentShaderStrokes) {
+		geometry(path, data.geometry, data.color.line,
+			enableFragmentShaderStrokes, acceleration) {
 
 		data.hasNormalFillStrokeOrder = path->hasNormalFillStrokeOrder();
 	}
@@ -48,6 +53,13 @@ public:
     virtual ToveShaderData *getData() {
     	return &data;
     }
+
+	virtual void addMemoryUsage(ToveMemoryUsage &usage) const {
+		addGradientMemoryUsage(data.color.line.gradient, 1, usage);
+		addGradientMemoryUsage(data.color.fill.gradient, 1, usage);
+		addGeometryMemoryUsage(data.geometry, usage);
+		geometry.addMemoryUsage(usage);
+	}
 };
 
 END_TOVE_NAMESPACE
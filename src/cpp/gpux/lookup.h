@@ -28,17 +28,71 @@ enum EventType {
 struct Event {
     float y;
     EventType t : 8;
-    uint8_t curve;
+    uint16_t curve;
 };
 
 enum {
     SENTINEL_END = 0xff,
-    SENTINEL_STROKES = 0xfe
+    SENTINEL_STROKES = 0xfe,
+
+    // 16-bit lists, used for paths with more than 253 curves. the
+    // shader might decode indices as fp16 (max 65504), so we use values
+    // fp16 represents exactly, and leave room for thresholds in between.
+    SENTINEL_END_16 = 0x6000,
+    SENTINEL_STROKES_16 = 0x5000
+};
+
+// curve lists are stored either as one byte per curve index, or, if
+// listsIndexSize is 2, as little-endian 16-bit indices (i.e. two indices
+// per rgba8 texel).
+class CurveList {
+private:
+	uint8_t *p;
+	const bool wide;
+
+public:
+	inline CurveList(uint8_t *p, bool wide) : p(p), wide(wide) {
+	}
+
+	inline void add(int curve) {
+		if (wide) {
+			p[0] = curve & 0xff;
+			p[1] = curve >> 8;
+			p += 2;
+		} else {
+			*p++ = curve;
+		}
+	}
+
+	inline void addStrokesMarker() {
+		add(wide ? SENTINEL_STROKES_16 : SENTINEL_STROKES);
+	}
+
+	inline void end() {
+		if (wide) {
+			p[0] = SENTINEL_END_16 & 0xff;
+			p[1] = SENTINEL_END_16 >> 8;
+		} else {
+			*p = SENTINEL_END;
+		}
+	}
+
+	// reads the next curve index; returns false at the end of the list.
+	inline bool next(int &curve) {
+		if (wide) {
+			curve = p[0] | (p[1] << 8);
+			p += 2;
+			return curve != SENTINEL_END_16;
+		} else {
+			curve = *p++;
+			return curve != SENTINEL_END;
+		}
+	}
 };
 
 class LookupTable {
 public:
-	typedef tsl::robin_set<uint8_t> CurveSet;
+	typedef tsl::robin_set<uint16_t> CurveSet;
 
 private:
     CurveSet active;
@@ -67,9 +121,11 @@ public:
 				printf("---------\n");
 			}
 			printf("lists %03d: ", y);
-			uint8_t *yptr = data->listsTexture + y * data->listsTextureRowBytes;
-			for (int x = 0; x < data->listsTextureSize[0]; x++) {
-				printf("%d ", yptr[x]);
+			CurveList list(data->listsTexture + y * data->listsTextureRowBytes,
+				data->listsIndexSize > 1);
+			int curve;
+			while (list.next(curve)) {
+				printf("%d ", curve);
 			}
 			printf("\n");
 		}
@@ -101,6 +157,7 @@ public:
 
 		uint8_t *yptr = data.listsTexture;
 		int rowBytes = data.listsTextureRowBytes;
+		const bool wide = data.listsIndexSize > 1;
 
 		yptr += dim * rowBytes * (data.listsTextureSize[1] / 2);
 
@@ -109,7 +166,8 @@ public:
         if (data.fragmentShaderLine && padding > 0.0) {
             const float y0 = i->y;
             *ylookup++ = y0 - padding;
-            finish(y0 - padding, y0, active, yptr, z++);
+            CurveList list(yptr, wide);
+            finish(y0 - padding, y0, active, list, z++);
             yptr += rowBytes;
         }
 
@@ -132,11 +190,11 @@ public:
 
             *ylookup++ = y0;
 
-            int k = 0;
-            assert(active.size() <= _maxCurves);
+            CurveList list(yptr, wide);
+            assert(int(active.size()) <= _maxCurves);
             for (const auto curve : active) {
 				if ((extended[curve].ignore & ignore) == 0) {
-					yptr[k++] = curve;
+					list.add(curve);
 				}
             }
 
@@ -151,13 +209,13 @@ public:
                 }
             }
 
-            finish(y0, y1, active, &yptr[k], z++);
+            finish(y0, y1, active, list, z++);
 
             i = j;
 			yptr += rowBytes;
         }
 
-        *yptr = SENTINEL_END;
+        CurveList(yptr, wide).end();
 
         data.lookupTableMeta->n[dim] = ylookup - lookupTable;
 		assert(data.lookupTableMeta->n[dim] <= data.lookupTableSize);
@@ -166,8 +224,8 @@ public:
     inline void build(int dim, const std::vector<Event> &events,
 		int numEvents, const std::vector<ExCurveData> &extended) {
         build(dim, events, numEvents, extended, 0.0,
-			[] (float y0, float y1, const CurveSet &active, uint8_t *list, int z) {
-            	*list = SENTINEL_END;
+			[] (float y0, float y1, const CurveSet &active, CurveList &list, int z) {
+            	list.end();
         	});
     }
 };
@@ -0,0 +1,340 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "reference.h"
+#include "lookup.h"
+#include "../utils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+BEGIN_TOVE_NAMESPACE
+
+// the functions below follow fill.frag as closely as possible,
+// including its numerical shortcuts, so that differences between
+// this and nsvg's rasterizer show up exactly as they would on a GPU.
+
+namespace {
+
+struct Curve {
+	float bx[4];
+	float by[4];
+	float bounds[4];
+};
+
+inline void fetchCurve(const ToveShaderGeometryData &g, int i, Curve &curve) {
+	const gpu_float_t *p = g.curvesTexture +
+		g.curvesTextureRowBytes * i / sizeof(gpu_float_t);
+	for (int k = 0; k < 4; k++) {
+		curve.bx[k] = load_gpu_float(p[k]);
+		curve.by[k] = load_gpu_float(p[k + 4]);
+		curve.bounds[k] = load_gpu_float(p[k + 8]);
+	}
+}
+
+inline float eval(const float *b, float t, float t2) {
+	return b[0] * t * t2 + b[1] * t2 + b[2] * t + b[3];
+}
+
+inline int clockwise(const float *by, float t, float t2) {
+	const float d = 3 * by[0] * t2 + 2 * by[1] * t + by[2];
+	return (d > 0.0f) - (d < 0.0f);
+}
+
+inline int contribute(const float *bx, const float *by, float t, float x, bool nonZero) {
+	const float t2 = t * t;
+	if (t >= 0.0f && t <= 1.0f && eval(bx, t, t2) > x) {
+		return nonZero ? clockwise(by, t, t2) : 1;
+	} else {
+		return 0;
+	}
+}
+
+inline int contribute3(const float *bx, const float *by, const float *t, float x, bool nonZero) {
+	int z = 0;
+	for (int k = 0; k < 3; k++) {
+		const float s = t[k];
+		const float s2 = s * s;
+		// note: as with goodT() in the shader, t == 1 does not count here.
+		if (s >= 0.0f && !(s >= 1.0f) && eval(bx, s, s2) >= x) {
+			z += nonZero ? clockwise(by, s, s2) : 1;
+		}
+	}
+	return z;
+}
+
+inline float cubicRoot(float r) {
+	return (r > 0.0f ? 1.0f : (r < 0.0f ? -1.0f : 0.0f)) *
+		std::pow(std::abs(r), 1.0f / 3.0f);
+}
+
+int advancedMagic(
+	const float *bx, const float *by, const float *P,
+	float position, float upperBound, bool nonZero) {
+
+	if (position > upperBound) {
+		return 0;
+	}
+
+	const float A = P[1] / P[0];
+
+	if (std::abs(P[0]) < 1e-2f || std::abs(A) > 1000.0f) {
+		if (std::abs(P[1]) < 1e-2f) {
+			// linear.
+			return contribute(bx, by, -P[3] / P[2], position, nonZero);
+		} else {
+			// quadratic.
+			const float a = P[1];
+			const float b = P[2];
+			const float c = P[3];
+
+			const float D = std::sqrt(b * b - 4 * a * c);
+			const float n = 2 * a;
+			int z = contribute(bx, by, (-b + D) / n, position, nonZero);
+			if (D > 0.0f) {
+				z += contribute(bx, by, (-b - D) / n, position, nonZero);
+			}
+			return z;
+		}
+	} else {
+		// cubic.
+		const float B = P[2] / P[0];
+		const float C = P[3] / P[0];
+
+		const float A2 = A * A;
+		const float Q = (3.0f * B - A2) / 9.0f;
+		const float R = (9.0f * A * B - 27.0f * C - 2 * A2 * A) / 54.0f;
+
+		const float A_third = A / 3.0f;
+		const float Q3 = Q * Q * Q;
+		const float D = Q3 + R * R;
+
+		if (D > 0.0f) { // complex or duplicate roots
+			const float sqrtD = std::sqrt(D);
+			const float S = cubicRoot(R + sqrtD);
+			const float T = cubicRoot(R - sqrtD);
+			const float st = S + T;
+
+			int z = contribute(bx, by, -A_third + st, position, nonZero);
+			if (std::abs(S - T) < 1e-2f) {
+				z += contribute(bx, by, -A_third - st / 2, position, nonZero) * 2;
+			}
+			return z;
+		} else { // distinct real roots
+			const float tmp0 = std::sqrt(std::max(0.0f, -Q3));
+			const float tmp1 = std::sqrt(std::max(0.0f, -Q));
+			const float phi = std::acos(clamp(R / tmp0, -1.0f, 1.0f));
+			float t[3];
+			for (int k = 0; k < 3; k++) {
+				t[k] = 2 * tmp1 * std::cos((phi + 2 * k * float(M_PI)) / 3.0f) - A_third;
+			}
+			return contribute3(bx, by, t, position, nonZero);
+		}
+	}
+}
+
+int searchLUT(const float *lut, int n, float position) {
+	return std::min(int(std::lower_bound(lut, lut + n, position) - lut), n - 1);
+}
+
+class ListReader {
+	const uint8_t *p;
+	const uint8_t *end;
+	const bool wide;
+
+public:
+	inline ListReader(const ToveShaderGeometryData &g, int row) :
+		p(g.listsTexture + row * g.listsTextureRowBytes),
+		end(p + g.listsTextureRowBytes),
+		wide(g.listsIndexSize > 1) {
+	}
+
+	// returns the next entry, or -1 at strokes marker or end.
+	inline int next() {
+		if (p >= end) {
+			return -1;
+		}
+		if (wide) {
+			const int i = p[0] | (p[1] << 8);
+			p += 2;
+			return i < SENTINEL_STROKES_16 ? i : -1;
+		} else {
+			const int i = *p++;
+			return i < SENTINEL_STROKES ? i : -1;
+		}
+	}
+};
+
+bool fillColor(const TovePaintData &paint, uint8_t *rgba) {
+	switch (paint.style) {
+		case PAINT_SOLID: {
+			const float c[4] = {paint.rgba.r, paint.rgba.g, paint.rgba.b, paint.rgba.a};
+			for (int i = 0; i < 4; i++) {
+				rgba[i] = uint8_t(clamp(c[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+			}
+			return true;
+		} break;
+
+		case PAINT_LINEAR_GRADIENT:
+		case PAINT_RADIAL_GRADIENT: {
+			// we only check coverage here; use the gradient's center color.
+			const ToveGradientData &g = paint.gradient;
+			if (!g.colorsTexture || g.colorsTextureHeight < 1) {
+				return false;
+			}
+			std::memcpy(rgba, g.colorsTexture +
+				(g.colorsTextureHeight / 2) * g.colorsTextureRowBytes, 4);
+			return true;
+		} break;
+
+		default: {
+			return false;
+		} break;
+	}
+}
+
+} // namespace
+
+bool rasterizeGPUXFill(
+	const ToveShaderData &data,
+	uint8_t *pixels,
+	int width, int height, int stride,
+	float tx, float ty, float scale) {
+
+	const ToveShaderGeometryData &g = data.geometry;
+
+	const bool grid = g.gridSize > 0;
+	if (!grid && !g.lookupTable[0]) {
+		return false; // mesh bands are not supported.
+	}
+	if (!g.bounds || !g.listsTexture || !g.curvesTexture || !g.lookupTableMeta) {
+		return false;
+	}
+
+	uint8_t color[4];
+	if (!fillColor(data.color.fill, color)) {
+		return true; // nothing to fill.
+	}
+
+	const bool nonZero = g.fillRule == TOVE_FILLRULE_NON_ZERO;
+	const float *bounds = g.bounds->bounds;
+	const ToveLookupTableMeta &meta = *g.lookupTableMeta;
+	const int numLists = g.listsTextureSize[1];
+	const float inverseScale = 1.0f / scale;
+
+	if (!grid && (meta.n[0] < 1 || meta.n[1] < 1)) {
+		return true;
+	}
+
+	Curve curve;
+	float P[4];
+	float ray[4];
+
+	for (int py = 0; py < height; py++) {
+		uint8_t *out = pixels + size_t(py) * stride;
+
+		for (int px = 0; px < width; px++, out += 4) {
+			float pos[2] = {
+				(px + 0.5f - tx) * inverseScale,
+				(py + 0.5f - ty) * inverseScale};
+
+			// the shader only runs inside the bounds quad.
+			if (pos[0] < bounds[0] || pos[0] > bounds[2] ||
+				pos[1] < bounds[1] || pos[1] > bounds[3]) {
+				continue;
+			}
+
+			bool rayOnX;
+			float rayFlip = 1.0f;
+			int row;
+
+			if (grid) {
+				const int size = g.gridSize;
+				float cellSize[2];
+				int cell[2];
+				for (int k = 0; k < 2; k++) {
+					cellSize[k] = std::max((bounds[k + 2] - bounds[k]) / size, 1e-6f);
+					cell[k] = std::max(0, std::min(size - 1,
+						int(std::floor((pos[k] - bounds[k]) / cellSize[k]))));
+				}
+				row = cell[1] * size + cell[0];
+			} else {
+				int at[2];
+				float p0[2], p1[2];
+				for (int k = 0; k < 2; k++) {
+					const float *lut = g.lookupTable[k];
+					at[k] = searchLUT(lut, meta.n[k], pos[k]);
+					p0[k] = lut[std::max(at[k] - 1, 0)];
+					p1[k] = lut[at[k]];
+				}
+
+				const float d0[2] = {pos[0] - p0[0], pos[1] - p0[1]};
+				const float d1[2] = {p1[0] - pos[0], p1[1] - pos[1]};
+				rayOnX = std::min(d0[0], d1[0]) < std::min(d0[1], d1[1]);
+
+				// reduce remaining numerical inaccuracies (see orient()).
+				const float margin = 0.5f;
+				float npos[2];
+				for (int k = 0; k < 2; k++) {
+					const float center = (p0[k] + p1[k]) / 2;
+					npos[k] = d0[k] >= margin ? pos[k] : std::min(p0[k] + margin, center);
+					npos[k] = d1[k] >= margin ? npos[k] : std::max(center, p1[k] - margin);
+				}
+				pos[rayOnX ? 1 : 0] = npos[rayOnX ? 1 : 0];
+
+				row = rayOnX ? at[1] - 1 + numLists / 2 : at[0] - 1;
+			}
+
+			ListReader list(g, std::max(0, std::min(row, numLists - 1)));
+
+			if (grid) {
+				// the first entry of each cell's list is its ray direction.
+				const int direction = list.next();
+				rayOnX = direction < 2;
+				rayFlip = (direction == 1 || direction == 3) ? -1.0f : 1.0f;
+			}
+
+			const int a1 = rayOnX ? 0 : 1; // ray axis
+			const int a2 = 1 - a1;
+			const float rayPos = pos[a1] * rayFlip;
+
+			int z = 0;
+			int i;
+			while ((i = list.next()) >= 0) {
+				fetchCurve(g, i, curve);
+
+				const float *along = rayOnX ? curve.bx : curve.by;
+				const float *across = rayOnX ? curve.by : curve.bx;
+
+				for (int k = 0; k < 4; k++) {
+					ray[k] = along[k] * rayFlip;
+				}
+				for (int k = 0; k < 4; k++) {
+					P[k] = rayOnX ? -across[k] : across[k];
+				}
+				P[3] += rayOnX ? pos[a2] : -pos[a2];
+
+				const float upperBound = rayFlip > 0.0f ?
+					curve.bounds[a1 + 2] : -curve.bounds[a1];
+
+				z += advancedMagic(ray, across, P, rayPos, upperBound, nonZero);
+			}
+
+			if (nonZero ? z != 0 : (z & 1) != 0) {
+				std::memcpy(out, color, 4);
+			}
+		}
+	}
+
+	return true;
+}
+
+END_TOVE_NAMESPACE
@@ -0,0 +1,33 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_GPUX_REFERENCE
+#define __TOVE_GPUX_REFERENCE 1
+
+#include "../common.h"
+
+BEGIN_TOVE_NAMESPACE
+
+// software version of the fill part of fill.frag. it reads the very
+// same data the shader gets (LUTs or grid, lists and curves texture)
+// and writes the fill color for each covered pixel into an RGBA8
+// buffer; uncovered pixels are left untouched (as on "discard").
+// pixel coordinates are mapped as in Graphics::rasterize.
+
+bool rasterizeGPUXFill(
+	const ToveShaderData &data,
+	uint8_t *pixels,
+	int width, int height, int stride,
+	float tx, float ty, float scale);
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_GPUX_REFERENCE
@@ -25,6 +25,7 @@
 #include "nsvg.h"
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 
 BEGIN_TOVE_NAMESPACE
 
@@ -61,6 +62,7 @@ void Graphics::rasterize(
 	float tx, float ty, float scale,
 	const ToveRasterizeSettings *settings) {
 
+	stats::Attribution attribution(counters.get());
 	nsvg::rasterize(getImage(), tx, ty, scale,
 		pixels, width, height, stride, settings);
 }
@@ -124,8 +126,19 @@ Clip::Clip(const ClipRef &source, const nsvg::Transform &transform) {
 	}
 }
 
-void Clip::compute(const AbstractTesselator &tess) {
-    computed = tess.toClipPath(paths);
+Clip::Clip(const ClipRef &source) {
+	std::memset(&nsvg, 0, sizeof(nsvg));
+	nsvg.index = source->nsvg.index;
+	for (const PathRef &sourcePath : source->paths) {
+		PathRef path = tove_make_shared<Path>(sourcePath.get(), true);
+		path->freeze();
+		if (paths.empty()) {
+			nsvg.shapes = &path->nsvg;
+		} else {
+			paths[paths.size() - 1]->setNext(path);
+		}
+		paths.push_back(path);
+	}
 }
 
 
@@ -153,6 +166,15 @@ ClipSet::ClipSet(const ClipSet &source, const nsvg::Transform &transform) {
 	}
 	link();
 }
+
+ClipSet::ClipSet(const ClipSet &source) {
+	const int numClips = source.clips.size();
+	clips.resize(numClips);
+	for (int i = 0; i < numClips; i++) {
+		clips[i] = tove_make_shared<Clip>(source.clips[i]);
+	}
+	link();
+}
 #endif
 
 void Graphics::setNumPaths(int n) {
@@ -178,6 +200,9 @@ void Graphics::_appendPath(const PathRef &path) {
 	paths.push_back(path);
 
 	path->addObserver(this);
+	if (editDepth > 0) {
+		enroll(path);
+	}
 
 	changed(CHANGED_GEOMETRY | CHANGED_COLORS);
 }
@@ -239,6 +264,16 @@ void Graphics::initialize(float width, float height) {
 
 	newPath = true;
 
+	static std::atomic<uint64_t> nextId(1);
+	id = nextId++;
+	version = 1;
+	inSet = false;
+	editDepth = 0;
+	counters = tove_make_shared<stats::Counters>();
+	setSourceVersion = 0;
+	setVersion = 0;
+	nsvg::xformIdentity(setMatrix);
+
 	for (int i = 0; i < 4; i++) {
 		bounds[i] = 0.0;
         exactBounds[i] = 0.0;
@@ -277,9 +312,7 @@ Graphics::Graphics(const NSVGimage *image) :
 #endif
 }
 
-Graphics::Graphics(const Graphics *graphics, bool clonePaths) :
-	changes(graphics->changes) {
-	
+void Graphics::copySettings(const Graphics *graphics) {
 	initialize(graphics->nsvg.width, graphics->nsvg.height);
 
 	strokeColor = graphics->strokeColor;
@@ -293,16 +326,78 @@ Graphics::Graphics(const Graphics *graphics, bool clonePaths) :
 	fillRule = graphics->fillRule;
 
 	clipSet = graphics->clipSet;
+}
+
+Graphics::Graphics(const Graphics *graphics, bool clonePaths, bool copyOnWrite) :
+	changes(graphics->changes) {
+	
+	copySettings(graphics);
 
 	for (const auto &path : graphics->paths) {
 		if (clonePaths) {
-			addPath(std::make_shared<Path>(path.get()));
+			addPath(std::make_shared<Path>(path.get(), copyOnWrite));
 		} else {
 			addPath(path);
 		}
 	}
 }
 
+Graphics::Graphics(const Graphics *graphics, const std::vector<PathRef> &paths) :
+	changes(graphics->changes) {
+
+	copySettings(graphics);
+
+	for (const auto &path : paths) {
+		addPath(path);
+	}
+}
+
+void Graphics::beginEdit() {
+	if (editDepth++ > 0) {
+		return;
+	}
+
+	for (const auto &path : paths) {
+		enroll(path);
+	}
+}
+
+void Graphics::enroll(const PathRef &path) {
+	const size_t first = editing.size();
+
+	editing.push_back(path);
+	const int n = path->getNumSubpaths();
+	for (int i = 0; i < n; i++) {
+		editing.push_back(path->getSubpath(i));
+	}
+	if (path->getFillColor()) {
+		editing.push_back(path->getFillColor());
+	}
+	if (path->getLineColor()) {
+		editing.push_back(path->getLineColor());
+	}
+
+	for (size_t i = first; i < editing.size(); i++) {
+		editing[i]->beginEdit();
+	}
+}
+
+void Graphics::endEdit() {
+	if (editDepth < 1 || --editDepth > 0) {
+		return;
+	}
+
+	// subpaths and paints come after their path, so going backwards
+	// has feeds hear about subpaths before hearing about their path.
+	// all of this counts as one broadcast.
+	const stats::Cascade cascade(stats::OBSERVER_BROADCASTS);
+	std::vector<SharedPtr<Observable>> observables;
+	observables.swap(editing);
+	for (auto i = observables.rbegin(); i != observables.rend(); i++) {
+		(*i)->endEdit();
+	}
+}
+
 void Graphics::clear() {
 	if (paths.size() > 0) {
 		for (const auto &p : paths) {
@@ -489,7 +584,77 @@ void Graphics::setOrientation(ToveOrientation orientation) {
 	}
 }
 
+bool Graphics::computeTransformDelta(
+	const GraphicsRef &source,
+	const nsvg::Transform &transform,
+	float *delta) const {
+
+	// computes the transform that maps our current points to the
+	// points we will have after set(source, transform).
+
+	if (source.get() == this) {
+		std::memcpy(delta, transform.getMatrix(), 6 * sizeof(float));
+	} else {
+		if (setSource.lock() != source ||
+			setSourceVersion != source->version ||
+			setVersion != version) {
+			return false;
+		}
+
+		float inverse[6];
+		nsvg::xformInverse(inverse, const_cast<float*>(setMatrix));
+		std::memcpy(delta, inverse, 6 * sizeof(float));
+		nsvg::xformMultiply(delta, transform.getMatrix());
+	}
+
+	bool hasStroke = false;
+	bool hasDashes = false;
+	for (const auto &path : paths) {
+		if (path->hasStroke()) {
+			hasStroke = true;
+			hasDashes = hasDashes || path->nsvg.strokeDashCount > 0;
+		}
+	}
+
+	if (hasStroke) {
+		// strokes only transform consistently under rotation, translation
+		// and uniform scale (checked against line widths in set()).
+
+		const float eps = 1e-4f;
+		const float sx = delta[0] * delta[0] + delta[1] * delta[1];
+		const float sy = delta[2] * delta[2] + delta[3] * delta[3];
+		const float skew = delta[0] * delta[2] + delta[1] * delta[3];
+
+		if (std::abs(sx - sy) > eps * std::max(sx, sy) ||
+			std::abs(skew) > eps * std::max(sx, sy)) {
+			return false;
+		}
+
+		if (hasDashes && std::abs(sx - 1.0f) > eps) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 void Graphics::set(const GraphicsRef &source, const nsvg::Transform &transform) {
+	const uint32_t version0 = version;
+
+	float delta[6];
+	bool affine = paths.size() == source->paths.size() &&
+		computeTransformDelta(source, transform, delta);
+
+	std::vector<float> lineWidths;
+	if (affine) {
+		lineWidths.reserve(paths.size());
+		for (const auto &path : paths) {
+			lineWidths.push_back(path->getLineWidth());
+		}
+	}
+
+	inSet = true;
+
 	const int numPaths = source->paths.size();
 	setNumPaths(numPaths);
 	for (int i = 0; i < numPaths; i++) {
@@ -504,6 +669,71 @@ void Graphics::set(const GraphicsRef &source, const nsvg::Transform &transform)
 	}
 	nsvg.clip.instances = clipSet ? clipSet->getHead() : nullptr;
 #endif
+
+	inSet = false;
+
+	if (affine) {
+		const float scale = std::sqrt(std::abs(delta[0] * delta[3] - delta[1] * delta[2]));
+		for (int i = 0; i < numPaths; i++) {
+			if (paths[i]->hasStroke() && std::abs(paths[i]->getLineWidth() -
+				lineWidths[i] * scale) > 1e-4f * std::max(1.0f, lineWidths[i])) {
+				affine = false;
+				break;
+			}
+		}
+	}
+
+	if (affine) {
+		if (!transformLog.empty() && transformLog.back().to != version0) {
+			transformLog.clear();
+		}
+		TransformStep step;
+		step.from = version0;
+		step.to = version;
+		std::memcpy(step.matrix, delta, 6 * sizeof(float));
+		transformLog.push_back(step);
+		while (transformLog.size() > 16) {
+			transformLog.pop_front();
+		}
+	} else {
+		transformLog.clear();
+	}
+
+	if (source.get() != this) {
+		setSource = source;
+		setSourceVersion = source->version;
+		std::memcpy(setMatrix, transform.getMatrix(), 6 * sizeof(float));
+	} else {
+		setSource.reset();
+	}
+	setVersion = version;
+}
+
+bool Graphics::getTransformSince(uint32_t since, float *matrix) const {
+	// if all changes since the given version were affine transforms,
+	// returns their combined transform.
+
+	if (since == version) {
+		nsvg::xformIdentity(matrix);
+		return true;
+	}
+
+	auto step = transformLog.begin();
+	while (step != transformLog.end() && step->from != since) {
+		step++;
+	}
+	if (step == transformLog.end()) {
+		return false;
+	}
+
+	std::memcpy(matrix, step->matrix, 6 * sizeof(float));
+	uint32_t at = step->to;
+	for (step++; step != transformLog.end() && step->from == at; step++) {
+		nsvg::xformMultiply(matrix, step->matrix);
+		at = step->to;
+	}
+
+	return at == version;
 }
 
 ToveChangeFlags Graphics::fetchChanges(ToveChangeFlags flags) {
@@ -513,7 +743,10 @@ ToveChangeFlags Graphics::fetchChanges(ToveChangeFlags flags) {
 	return c;
 }
 
-bool Graphics::morphify(const std::vector<GraphicsRef> &graphics) {
+bool Graphics::morphify(
+	const std::vector<GraphicsRef> &graphics,
+	ToveMorphStrategy strategy) {
+
 	if (graphics.size() < 2) {
 		return false;
 	}
@@ -533,12 +766,106 @@ bool Graphics::morphify(const std::vector<GraphicsRef> &graphics) {
 		for (int i = 0; i < graphics.size(); i++) {
 			paths.push_back(graphics[i]->getPath(j));
 		}
-		Path::morphify(paths);
+		Path::morphify(paths, strategy);
 	}
 
 	return true;	
 }
 
+int Graphics::getNumSubpaths() const {
+	int n = 0;
+	for (const auto &path : paths) {
+		n += path->getNumSubpaths();
+	}
+	return n;
+}
+
+int Graphics::getPointOffsets(int *offsets) const {
+	int k = 0;
+	int offset = 0;
+	for (const auto &path : paths) {
+		const int n = path->getNumSubpaths();
+		for (int i = 0; i < n; i++) {
+			offsets[k++] = offset;
+			offset += path->getSubpath(i)->getLoveNumPoints();
+		}
+	}
+	offsets[k] = offset;
+	return offset;
+}
+
+void Graphics::getPoints(float *pts) const {
+	for (const auto &path : paths) {
+		const int n = path->getNumSubpaths();
+		for (int i = 0; i < n; i++) {
+			const SubpathRef subpath = path->getSubpath(i);
+			const int npts = subpath->getLoveNumPoints();
+			std::memcpy(pts, subpath->getPoints(), npts * 2 * sizeof(float));
+			pts += npts * 2;
+		}
+	}
+}
+
+void Graphics::setPoints(const float *pts, const int *offsets) {
+	beginEdit();
+	int k = 0;
+	for (const auto &path : paths) {
+		const int n = path->getNumSubpaths();
+		for (int i = 0; i < n; i++, k++) {
+			path->getSubpath(i)->setPoints(
+				pts + 2 * offsets[k], offsets[k + 1] - offsets[k]);
+		}
+	}
+	endEdit();
+}
+
+void Graphics::getPointsPtrs(float **ptrs) const {
+	for (const auto &path : paths) {
+		const int n = path->getNumSubpaths();
+		for (int i = 0; i < n; i++) {
+			*ptrs++ = path->getSubpath(i)->editPoints();
+		}
+	}
+}
+
+void Graphics::pointsChanged() {
+	beginEdit();
+	for (const auto &path : paths) {
+		const int n = path->getNumSubpaths();
+		for (int i = 0; i < n; i++) {
+			const SubpathRef subpath = path->getSubpath(i);
+			subpath->fixLoop();
+			subpath->changed(CHANGED_POINTS);
+		}
+	}
+	endEdit();
+}
+
+void Graphics::addMemoryUsage(ToveMemoryUsage &usage) const {
+	usage.nsvg += sizeof(nsvg);
+	footprint::add(usage.nsvg, usage, paths);
+	for (const auto &path : paths) {
+		path->addMemoryUsage(usage);
+	}
+	if (fillColor) {
+		fillColor->addMemoryUsage(usage);
+	}
+	if (strokeColor) {
+		strokeColor->addMemoryUsage(usage);
+	}
+	if (paintIndices) {
+		paintIndices->addMemoryUsage(usage);
+	}
+}
+
+void Graphics::compact() {
+	for (const auto &path : paths) {
+		path->compact();
+	}
+	paths.shrink_to_fit();
+	strokeDashes.shrink_to_fit();
+}
+
 void Graphics::rotate(ToveElementType what, int k) {
 	switch (what) {
 		case TOVE_PATH: {
@@ -579,11 +906,15 @@ void Graphics::animate(const GraphicsRef &a, const GraphicsRef &b, float t) {
 	}
 }
 
-void Graphics::computeClipPaths(const AbstractTesselator &tess) const {
+void Graphics::computeClipPaths(
+	const AbstractTesselator &tess,
+	std::vector<ClipperLib::Paths> &clipPaths) const {
+
+	clipPaths.clear();
 #ifdef NSVG_CLIP_PATHS
 	if (clipSet) {
 		for (const ClipRef &clip : clipSet->getClips()) {
-			clip->compute(tess);
+			clipPaths.push_back(tess.toClipPath(clip->paths));
 		}
 	}
 #endif
@@ -13,6 +13,8 @@
 #define __TOVE_GRAPHICS 1
 
 #include "path.h"
+#include "stats.h"
+#include <deque>
 
 BEGIN_TOVE_NAMESPACE
 
@@ -27,15 +29,15 @@ public:
 	Clip(TOVEclipPath *path);
 	Clip(const ClipRef &source, const nsvg::Transform &transform);
 
+	// a frozen copy-on-write clone of source, see Path::freeze().
+	Clip(const ClipRef &source);
+
 	inline void setNext(ClipRef clip) {
 		nsvg.next = &clip->nsvg;
 	}
 
-	void compute(const AbstractTesselator &tess);
-
 	TOVEclipPath nsvg;
 	std::vector<PathRef> paths;
-	ClipperLib::Paths computed;
 };
 
 class ClipSet : public Referencable { // clip sets are immutable.
@@ -47,6 +49,9 @@ public:
 	ClipSet(const std::vector<ClipRef> &c);
 	ClipSet(const ClipSet &source, const nsvg::Transform &t);
 
+	// frozen clones of all of source's clips.
+	ClipSet(const ClipSet &source);
+
 	TOVEclipPath *getHead() const {
 		return clips.size() > 0 ? &clips[0]->nsvg : nullptr;
 	}
@@ -81,6 +86,10 @@ public:
 	inline int getNumGradients() const {
 		return size.gradient;
 	}
+
+	inline void addMemoryUsage(ToveMemoryUsage &usage) const {
+		footprint::add(usage.paints, usage, paints);
+	}
 };
 
 typedef SharedPtr<PaintIndices> PaintIndicesRef;
@@ -111,6 +120,48 @@ private:
 	ToveChangeFlags changes;
 	PaintIndicesRef paintIndices;
 
+	// every change increments version. transformLog records those
+	// version steps that consisted of nothing but an affine transform
+	// applied by set(); this allows meshes to catch up by transforming
+	// their vertices instead of being rebuilt.
+	struct TransformStep {
+		uint32_t from;
+		uint32_t to;
+		float matrix[6];
+	};
+
+	uint32_t version;
+	std::deque<TransformStep> transformLog;
+
+	// unique over the process lifetime, unlike our address (which a
+	// pool may hand to the next Graphics), see AbstractMesh::mSource.
+	uint64_t id;
+	bool inSet;
+
+	// paths, subpaths and paints that hold back their change
+	// broadcasts to feeds until the outermost endEdit().
+	std::vector<SharedPtr<Observable>> editing;
+	int editDepth;
+
+	void enroll(const PathRef &path);
+
+	// the last snapshot taken, see GraphicsSnapshot.
+	std::weak_ptr<GraphicsSnapshot> snapshot;
+	friend class GraphicsSnapshot;
+
+	// work done on this graphics and its snapshots, see stats.h.
+	SharedPtr<stats::Counters> counters;
+
+	std::weak_ptr<Graphics> setSource;
+	uint32_t setSourceVersion;
+	uint32_t setVersion;
+	float setMatrix[6];
+
+	bool computeTransformDelta(
+		const GraphicsRef &source,
+		const nsvg::Transform &transform,
+		float *delta) const;
+
 	inline const PathRef &current() const {
 		return paths[paths.size() - 1];
 	}
@@ -119,6 +170,7 @@ private:
 	void _appendPath(const PathRef &path);
 
 	void initialize(float width, float height);
+	void copySettings(const Graphics *graphics);
 
 	template<typename Get>
 	void computeBounds(float *bounds, const Get &get) {
@@ -157,9 +209,14 @@ public:
 	Graphics();
 	Graphics(const ClipSetRef &clipSet);
 	Graphics(const NSVGimage *image);
-	Graphics(const Graphics *graphics, bool clonePaths);
+	Graphics(const Graphics *graphics, bool clonePaths, bool copyOnWrite = false);
+	Graphics(const Graphics *graphics, const std::vector<PathRef> &paths);
 
 	inline ~Graphics() {
+		if (editDepth > 0) {
+			editDepth = 1;
+			endEdit();
+		}
 		clear();
 	}
 
@@ -246,20 +303,77 @@ public:
 			flags |= CHANGED_PAINT_INDICES;
 		}
 		changes |= flags;
+
+		version++;
+		if (!inSet) {
+			transformLog.clear();
+		}
 	}
 
 	virtual void observableChanged(Observable *observable, ToveChangeFlags flags) {
 		changed(flags);
 	}
 
+	virtual bool isOwner() const {
+		return true;
+	}
+
+	// edits between beginEdit() and endEdit() reach feeds as one combined
+	// change at the end. paths and this graphics see each change as it
+	// happens, so bounds, versions, hits and tesselations stay current.
+	// paths and subpaths added during the edit join it.
+	void beginEdit();
+	void endEdit();
+
+	inline uint32_t getVersion() const {
+		return version;
+	}
+
+	inline uint64_t getId() const {
+		return id;
+	}
+
+	inline stats::Counters *getCounters() const {
+		return counters.get();
+	}
+
+	bool getTransformSince(uint32_t version, float *matrix) const;
+
 	ToveChangeFlags fetchChanges(ToveChangeFlags flags);
 	void clearChanges(ToveChangeFlags flags);
 
 	void animate(const GraphicsRef &a, const GraphicsRef &b, float t);
-	static bool morphify(const std::vector<GraphicsRef> &graphics);
+	static bool morphify(
+		const std::vector<GraphicsRef> &graphics,
+		ToveMorphStrategy strategy = TOVE_MORPH_MINIMAL);
 	void rotate(ToveElementType what, int k);
 
-	void computeClipPaths(const AbstractTesselator &tess) const;
+	// bulk access to the points of all subpaths of all paths, in order.
+	// offsets has getNumSubpaths() + 1 entries, the points of subpath i
+	// being [offsets[i], offsets[i + 1]). as with Subpath::getLoveNumPoints,
+	// the duplicated last point of closed subpaths is not included.
+	int getNumSubpaths() const;
+	int getPointOffsets(int *offsets) const;
+	void getPoints(float *pts) const;
+	void setPoints(const float *pts, const int *offsets);
+
+	// direct access to each subpath's points; call pointsChanged()
+	// after writing to them.
+	void getPointsPtrs(float **ptrs) const;
+	void pointsChanged();
+
+	void addMemoryUsage(ToveMemoryUsage &usage) const;
+
+	// trims the storage of all paths to their current size, which saves
+	// memory for static content. pointers from getPointsPtrs() become
+	// invalid.
+	void compact();
+
+	// flattens all clip paths, indexed by clip index. tesselators keep
+	// the result, as the clips might be shared with other graphics.
+	void computeClipPaths(
+		const AbstractTesselator &tess,
+		std::vector<ClipperLib::Paths> &clipPaths) const;
 
 #ifdef NSVG_CLIP_PATHS
 	inline const ClipSetRef &getClipSet() const {
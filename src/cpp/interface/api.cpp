@@ -13,14 +13,20 @@
 #include "../references.h"
 #include "../path.h"
 #include "../graphics.h"
+#include "../timeline.h"
+#include "../jobs.h"
+#include "../snapshot.h"
 #include "../palette.h"
 #include "../mesh/mesh.h"
 #include "../mesh/meshifier.h"
 #include "../mesh/flatten.h"
 #include "../shader/feed/color_feed.h"
 #include "../gpux/gpux_feed.h"
+#include "../gpux/atlas_feed.h"
+#include "../gpux/reference.h"
 #include "../../thirdparty/bluenoise.h"
 #include <sstream>
+#include <cstring>
 #include <vector>
 
 #if TOVE_TARGET == TOVE_TARGET_LOVE2D
@@ -384,11 +390,11 @@ void PathSetLineColor(TovePathRef path, TovePaintRef color) {
 }
 
 TovePaintRef PathGetFillColor(TovePathRef path) {
-	return paints.publishOrNil(deref(path)->getFillColor());
+	return paints.publishOrNil(deref(path)->editFillColor());
 }
 
 TovePaintRef PathGetLineColor(TovePathRef path) {
-	return paints.publishOrNil(deref(path)->getLineColor());
+	return paints.publishOrNil(deref(path)->editLineColor());
 }
 
 void PathSetLineDash(TovePathRef path, const float *dashes, int count) {
@@ -587,7 +593,7 @@ void SubpathSetIsClosed(ToveSubpathRef subpath, bool closed) {
 }
 
 float *SubpathGetPointsPtr(ToveSubpathRef subpath) {
-	return deref(subpath)->getPoints();
+	return deref(subpath)->editPoints();
 }
 
 void SubpathFixLoop(ToveSubpathRef subpath) {
@@ -745,6 +751,10 @@ ToveGraphicsRef CloneGraphics(ToveGraphicsRef graphics, bool deep) {
 	return shapes.publish(tove_make_shared<Graphics>(deref(graphics).get(), deep));
 }
 
+ToveGraphicsRef CloneGraphicsCopyOnWrite(ToveGraphicsRef graphics) {
+	return shapes.publish(tove_make_shared<Graphics>(deref(graphics).get(), true, true));
+}
+
 TovePathRef GraphicsBeginPath(ToveGraphicsRef graphics) {
 	return paths.publish(deref(graphics)->beginPath());
 }
@@ -934,23 +944,129 @@ void GraphicsSetLineCap(ToveGraphicsRef graphics, ToveLineCap cap) {
 }
 
 bool GraphicsMorphify(const ToveGraphicsRef *graphics, int n) {
+	return GraphicsMorphifyWith(graphics, n, TOVE_MORPH_MINIMAL);
+}
+
+bool GraphicsMorphifyWith(
+	const ToveGraphicsRef *graphics,
+	int n,
+	ToveMorphStrategy strategy) {
 	std::vector<GraphicsRef> g;
 	g.reserve(n);
 	for (int i = 0; i < n; i++) {
 		g.push_back(deref(graphics[i]));
 	}
-	return Graphics::morphify(g);
+	return Graphics::morphify(g, strategy);
 }
 
 void GraphicsRotate(ToveGraphicsRef graphics, ToveElementType what, int k) {
 	deref(graphics)->rotate(what, k);
 }
 
+void GraphicsBeginEdit(ToveGraphicsRef graphics) {
+	deref(graphics)->beginEdit();
+}
+
+void GraphicsEndEdit(ToveGraphicsRef graphics) {
+	deref(graphics)->endEdit();
+}
+
+int GraphicsGetNumSubpaths(ToveGraphicsRef graphics) {
+	return deref(graphics)->getNumSubpaths();
+}
+
+int GraphicsGetPointOffsets(ToveGraphicsRef graphics, int *offsets) {
+	return deref(graphics)->getPointOffsets(offsets);
+}
+
+void GraphicsGetPoints(ToveGraphicsRef graphics, float *pts) {
+	deref(graphics)->getPoints(pts);
+}
+
+void GraphicsSetPoints(ToveGraphicsRef graphics, const float *pts, const int *offsets) {
+	deref(graphics)->setPoints(pts, offsets);
+}
+
+void GraphicsGetPointsPtrs(ToveGraphicsRef graphics, float **ptrs) {
+	deref(graphics)->getPointsPtrs(ptrs);
+}
+
+void GraphicsPointsChanged(ToveGraphicsRef graphics) {
+	deref(graphics)->pointsChanged();
+}
+
 void ReleaseGraphics(ToveGraphicsRef graphics) {
 	shapes.release(graphics);
 }
 
 
+ToveTimelineRef NewTimeline() {
+	return timelines.make();
+}
+
+void TimelineAddKeyframe(
+	ToveTimelineRef timeline,
+	ToveGraphicsRef graphics,
+	float duration,
+	ToveEasing easing) {
+	deref(timeline)->addKeyframe(deref(graphics), duration, easing);
+}
+
+int TimelineGetNumKeyframes(ToveTimelineRef timeline) {
+	return deref(timeline)->getNumKeyframes();
+}
+
+float TimelineGetDuration(ToveTimelineRef timeline) {
+	return deref(timeline)->getDuration();
+}
+
+void TimelineSetMode(ToveTimelineRef timeline, ToveTimelineMode mode) {
+	deref(timeline)->setMode(mode);
+}
+
+void TimelineSetInterpolation(
+	ToveTimelineRef timeline,
+	ToveInterpolation interpolation,
+	float tension) {
+	deref(timeline)->setInterpolation(interpolation, tension);
+}
+
+void TimelineEvaluate(ToveTimelineRef timeline, ToveGraphicsRef graphics, float t) {
+	deref(timeline)->evaluate(deref(graphics), t);
+}
+
+ToveAtlasLayout TimelineGetAtlasLayout(
+	ToveTimelineRef timeline,
+	float fps,
+	int frameWidth,
+	int frameHeight,
+	int padding,
+	int maxWidth) {
+	return deref(timeline)->getAtlasLayout(
+		fps, frameWidth, frameHeight, padding, maxWidth);
+}
+
+bool TimelineRasterizeAtlas(
+	ToveTimelineRef timeline,
+	const ToveAtlasLayout *layout,
+	float fps,
+	uint8_t *pixels,
+	int stride,
+	float tx,
+	float ty,
+	float scale,
+	const ToveRasterizeSettings *settings,
+	int numThreads,
+	ToveAtlasFrame *frames) {
+	return deref(timeline)->rasterizeAtlas(*layout, fps,
+		pixels, stride, tx, ty, scale, settings, numThreads, frames);
+}
+
+void ReleaseTimeline(ToveTimelineRef timeline) {
+	timelines.release(timeline);
+}
+
+
 ToveFeedRef NewColorFeed(ToveGraphicsRef graphics, float scale) {
 	return shaderLinks.publish(tove_make_shared<ColorFeed>(deref(graphics), scale));
 }
@@ -960,6 +1076,12 @@ ToveFeedRef NewGeometryFeed(TovePathRef path, bool enableFragmentShaderStrokes)
 		deref(path), enableFragmentShaderStrokes));
 }
 
+ToveFeedRef NewGeometryFeedWith(TovePathRef path,
+	bool enableFragmentShaderStrokes, ToveGPUXAcceleration acceleration) {
+	return shaderLinks.publish(tove_make_shared<GPUXFeed>(
+		deref(path), enableFragmentShaderStrokes, acceleration));
+}
+
 ToveChangeFlags FeedBeginUpdate(ToveFeedRef link) {
 	return deref(link)->beginUpdate();
 }
@@ -972,6 +1094,19 @@ ToveShaderData *FeedGetData(ToveFeedRef link) {
 	return deref(link)->getData();
 }
 
+ToveFeedRef NewGPUXAtlasFeed(ToveGraphicsRef graphics) {
+	return shaderLinks.publish(tove_make_shared<GPUXAtlasFeed>(deref(graphics)));
+}
+
+ToveGPUXAtlasData *FeedGetGPUXAtlasData(ToveFeedRef link) {
+	return deref(link)->getAtlasData();
+}
+
+bool RasterizeGPUXFill(const ToveShaderData *data, uint8_t *pixels,
+	int width, int height, int stride, float tx, float ty, float scale) {
+	return rasterizeGPUXFill(*data, pixels, width, height, stride, tx, ty, scale);
+}
+
 TovePaintColorAllocation FeedGetColorAllocation(ToveFeedRef link) {
 	return deref(link)->getColorAllocation();
 }
@@ -1023,6 +1158,53 @@ void MeshCopyIndexData(ToveMeshRef mesh, void *buffer, int32_t size) {
 		size / sizeof(ToveVertexIndex));
 }
 
+int MeshGetUnmaskedIndexCount(ToveMeshRef mesh) {
+	return deref(mesh)->getIndexCount(false);
+}
+
+void MeshCopyUnmaskedIndexData(ToveMeshRef mesh, void *buffer, int32_t size) {
+	deref(mesh)->copyIndexData(
+		static_cast<ToveVertexIndex*>(buffer),
+		size / sizeof(ToveVertexIndex),
+		false);
+}
+
+void MeshSetPathVisible(ToveMeshRef mesh, int path, bool visible) {
+	deref(mesh)->setPathVisible(path, visible);
+}
+
+bool MeshIsPathVisible(ToveMeshRef mesh, int path) {
+	return deref(mesh)->isPathVisible(path);
+}
+
+bool MeshGetPathRange(ToveMeshRef mesh, int path, ToveMeshRange *range) {
+	return deref(mesh)->getPathRange(path, *range);
+}
+
+int MeshGetDrawRanges(ToveMeshRef mesh, ToveMeshRange *ranges, int maxRanges) {
+	return deref(mesh)->getDrawRanges(ranges, maxRanges);
+}
+
+int MeshGetDirtyRanges(ToveMeshRef mesh,
+	ToveByteRange *ranges, int maxRanges, uint32_t *indexVersion) {
+
+	const MeshRef &m = deref(mesh);
+	if (indexVersion) {
+		*indexVersion = m->getIndexVersion();
+	}
+	return m->getDirtyRanges(ranges, maxRanges);
+}
+
+int MeshGetSubmeshIndices(ToveMeshRef mesh,
+	ToveSubmeshIndices *submeshes, int maxSubmeshes) {
+
+	return deref(mesh)->getSubmeshIndices(submeshes, maxSubmeshes);
+}
+
+void MeshClearDirtyRanges(ToveMeshRef mesh) {
+	deref(mesh)->clearDirty();
+}
+
 void MeshCacheKeyFrame(ToveMeshRef mesh) {
 	deref(mesh)->cacheKeyFrame();
 }
@@ -1045,6 +1227,11 @@ ToveTesselatorRef NewRigidTesselator(int subdivisions) {
 	return tesselators.publish(tove_make_shared<RigidTesselator>(subdivisions));
 }
 
+ToveTesselatorRef NewRigidTesselatorWithTolerance(int subdivisions, float tolerance) {
+	return tesselators.publish(tove_make_shared<RigidTesselator>(
+		subdivisions, tolerance));
+}
+
 ToveMeshUpdateFlags TesselatorTessGraphics(ToveTesselatorRef tess,
 	ToveGraphicsRef graphics, ToveMeshRef mesh, ToveMeshUpdateFlags flags) {
 
@@ -1063,6 +1250,7 @@ ToveMeshUpdateFlags TesselatorTessPath(ToveTesselatorRef tess,
 	int lineIndex = 0;
 	int fillIndex = 0;
 
+	stats::Attribution attribution(deref(graphics)->getCounters());
 	deref(tess)->beginTesselate(deref(graphics).get(), 1.0f / extent);
 
 	PathPaintInd empty;
@@ -1073,6 +1261,10 @@ ToveMeshUpdateFlags TesselatorTessPath(ToveTesselatorRef tess,
 
 	deref(tess)->endTesselate();
 
+	// vertices no longer correspond to a version of graphics.
+	deref(fillMesh)->setSource(nullptr);
+	deref(lineMesh)->setSource(nullptr);
+
 	return result;
 }
 
@@ -1123,6 +1315,141 @@ const char *NameCStr(ToveNameRef name) {
 }
 
 
+ToveSnapshotRef NewGraphicsSnapshot(ToveGraphicsRef graphics) {
+	return snapshots.publish(GraphicsSnapshot::capture(deref(graphics)));
+}
+
+uint32_t SnapshotGetVersion(ToveSnapshotRef snapshot) {
+	return deref(snapshot)->getVersion();
+}
+
+void ReleaseSnapshot(ToveSnapshotRef snapshot) {
+	snapshots.release(snapshot);
+}
+
+void SetNumJobThreads(int numThreads) {
+	setNumJobThreads(numThreads);
+}
+
+ToveJobRef TesselatorTessGraphicsAsync(ToveTesselatorRef tess,
+	ToveGraphicsRef graphics, ToveMeshRef mesh, ToveMeshUpdateFlags flags) {
+
+	// the tesselator and the mesh must not be used elsewhere until
+	// the job has finished.
+	return jobs.publish(submitTesselation(deref(tess),
+		GraphicsSnapshot::capture(deref(graphics)), deref(mesh), flags));
+}
+
+ToveJobRef TesselatorTessSnapshotAsync(ToveTesselatorRef tess,
+	ToveSnapshotRef snapshot, ToveMeshRef mesh, ToveMeshUpdateFlags flags) {
+
+	return jobs.publish(submitTesselation(
+		deref(tess), deref(snapshot), deref(mesh), flags));
+}
+
+ToveJobRef GraphicsRasterizeAsync(
+	ToveGraphicsRef graphics, uint8_t *pixels, int width, int height, int stride,
+	float tx, float ty, float scale, const ToveRasterizeSettings *settings) {
+
+	return jobs.publish(submitRasterization(
+		GraphicsSnapshot::capture(deref(graphics)),
+		pixels, width, height, stride, tx, ty, scale, settings));
+}
+
+ToveJobRef SnapshotRasterizeAsync(
+	ToveSnapshotRef snapshot, uint8_t *pixels, int width, int height, int stride,
+	float tx, float ty, float scale, const ToveRasterizeSettings *settings) {
+
+	return jobs.publish(submitRasterization(deref(snapshot),
+		pixels, width, height, stride, tx, ty, scale, settings));
+}
+
+ToveJobRef NewGraphicsAsync(const char *svg, const char* units, float dpi) {
+	return jobs.publish(submitParse(svg, units, dpi));
+}
+
+ToveJobStatus JobGetStatus(ToveJobRef job) {
+	return deref(job)->getStatus();
+}
+
+ToveJobStatus JobWait(ToveJobRef job) {
+	return deref(job)->wait();
+}
+
+ToveMeshUpdateFlags JobGetMeshUpdateFlags(ToveJobRef job) {
+	const JobRef &j = deref(job);
+	if (j->getStatus() != TOVE_JOB_DONE) {
+		return 0;
+	}
+	return j->getUpdateFlags();
+}
+
+ToveGraphicsRef JobGetGraphics(ToveJobRef job) {
+	const JobRef &j = deref(job);
+	if (j->getStatus() != TOVE_JOB_DONE) {
+		return shapes.publishOrNil(GraphicsRef());
+	}
+	return shapes.publishOrNil(j->getGraphics());
+}
+
+void ReleaseJob(ToveJobRef job) {
+	jobs.release(job);
+}
+
+void SetTraceEnabled(bool enabled) {
+	trace::setEnabled(enabled);
+}
+
+void ClearTrace() {
+	trace::clear();
+}
+
+const char *GetTraceJSON() {
+	// valid until the next call.
+	static std::string json;
+	json = trace::exportJSON();
+	return json.c_str();
+}
+
+void GetStats(ToveStats *stats) {
+	stats::global.get(stats);
+}
+
+void ResetStats() {
+	stats::global.reset();
+}
+
+void GraphicsGetStats(ToveGraphicsRef graphics, ToveStats *stats) {
+	deref(graphics)->getCounters()->get(stats);
+}
+
+void GraphicsResetStats(ToveGraphicsRef graphics) {
+	deref(graphics)->getCounters()->reset();
+}
+
+void GraphicsGetMemoryUsage(ToveGraphicsRef graphics, ToveMemoryUsage *usage) {
+	std::memset(usage, 0, sizeof(ToveMemoryUsage));
+	deref(graphics)->addMemoryUsage(*usage);
+}
+
+void MeshGetMemoryUsage(ToveMeshRef mesh, ToveMemoryUsage *usage) {
+	std::memset(usage, 0, sizeof(ToveMemoryUsage));
+	deref(mesh)->addMemoryUsage(*usage);
+}
+
+void FeedGetMemoryUsage(ToveFeedRef link, ToveMemoryUsage *usage) {
+	std::memset(usage, 0, sizeof(ToveMemoryUsage));
+	deref(link)->addMemoryUsage(*usage);
+}
+
+void GraphicsCompact(ToveGraphicsRef graphics) {
+	deref(graphics)->compact();
+}
+
+void MeshCompact(ToveMeshRef mesh) {
+	deref(mesh)->compact();
+}
+
 } // extern "C"
 
 #endif // TOVE_TARGET_LOVE2D
@@ -110,6 +110,7 @@ EXPORT void ReleasePath(TovePathRef path);
 
 EXPORT ToveGraphicsRef NewGraphics(const char *svg, const char* units, float dpi);
 EXPORT ToveGraphicsRef CloneGraphics(ToveGraphicsRef graphics, bool deep);
+EXPORT ToveGraphicsRef CloneGraphicsCopyOnWrite(ToveGraphicsRef graphics);
 EXPORT TovePathRef GraphicsBeginPath(ToveGraphicsRef graphics);
 EXPORT void GraphicsClosePath(ToveGraphicsRef graphics);
 EXPORT ToveSubpathRef GraphicsBeginSubpath(ToveGraphicsRef graphics);
@@ -146,14 +147,46 @@ EXPORT void GraphicsClearChanges(ToveGraphicsRef shape);
 EXPORT ToveLineJoin GraphicsGetLineJoin(ToveGraphicsRef shape);
 EXPORT void GraphicsSetLineJoin(ToveGraphicsRef shape, ToveLineJoin join);
 EXPORT bool GraphicsMorphify(const ToveGraphicsRef *graphics, int n);
+EXPORT bool GraphicsMorphifyWith(const ToveGraphicsRef *graphics, int n,
+	ToveMorphStrategy strategy);
 EXPORT void GraphicsRotate(ToveGraphicsRef graphics, ToveElementType what, int k);
+EXPORT void GraphicsBeginEdit(ToveGraphicsRef graphics);
+EXPORT void GraphicsEndEdit(ToveGraphicsRef graphics);
+EXPORT int GraphicsGetNumSubpaths(ToveGraphicsRef graphics);
+EXPORT int GraphicsGetPointOffsets(ToveGraphicsRef graphics, int *offsets);
+EXPORT void GraphicsGetPoints(ToveGraphicsRef graphics, float *pts);
+EXPORT void GraphicsSetPoints(ToveGraphicsRef graphics, const float *pts, const int *offsets);
+EXPORT void GraphicsGetPointsPtrs(ToveGraphicsRef graphics, float **ptrs);
+EXPORT void GraphicsPointsChanged(ToveGraphicsRef graphics);
 EXPORT void ReleaseGraphics(ToveGraphicsRef shape);
 
+EXPORT ToveTimelineRef NewTimeline();
+EXPORT void TimelineAddKeyframe(ToveTimelineRef timeline,
+	ToveGraphicsRef graphics, float duration, ToveEasing easing);
+EXPORT int TimelineGetNumKeyframes(ToveTimelineRef timeline);
+EXPORT float TimelineGetDuration(ToveTimelineRef timeline);
+EXPORT void TimelineSetMode(ToveTimelineRef timeline, ToveTimelineMode mode);
+EXPORT void TimelineSetInterpolation(ToveTimelineRef timeline,
+	ToveInterpolation interpolation, float tension);
+EXPORT void TimelineEvaluate(ToveTimelineRef timeline, ToveGraphicsRef graphics, float t);
+EXPORT ToveAtlasLayout TimelineGetAtlasLayout(ToveTimelineRef timeline, float fps,
+	int frameWidth, int frameHeight, int padding, int maxWidth);
+EXPORT bool TimelineRasterizeAtlas(ToveTimelineRef timeline, const ToveAtlasLayout *layout,
+	float fps, uint8_t *pixels, int stride, float tx, float ty, float scale,
+	const ToveRasterizeSettings *settings, int numThreads, ToveAtlasFrame *frames);
+EXPORT void ReleaseTimeline(ToveTimelineRef timeline);
+
 EXPORT ToveFeedRef NewColorFeed(ToveGraphicsRef graphics, float scale);
 EXPORT ToveFeedRef NewGeometryFeed(TovePathRef path, bool enableFragmentShaderStrokes);
+EXPORT ToveFeedRef NewGeometryFeedWith(TovePathRef path,
+	bool enableFragmentShaderStrokes, ToveGPUXAcceleration acceleration);
 EXPORT ToveChangeFlags FeedBeginUpdate(ToveFeedRef link);
 EXPORT ToveChangeFlags FeedEndUpdate(ToveFeedRef link);
 EXPORT ToveShaderData *FeedGetData(ToveFeedRef link);
+EXPORT ToveFeedRef NewGPUXAtlasFeed(ToveGraphicsRef graphics);
+EXPORT ToveGPUXAtlasData *FeedGetGPUXAtlasData(ToveFeedRef link);
+EXPORT bool RasterizeGPUXFill(const ToveShaderData *data, uint8_t *pixels,
+	int width, int height, int stride, float tx, float ty, float scale);
 EXPORT TovePaintColorAllocation FeedGetColorAllocation(ToveFeedRef link);
 EXPORT void FeedBindPaintIndices(ToveFeedRef link, const ToveGradientData *data);
 EXPORT void ReleaseFeed(ToveFeedRef link);
@@ -168,12 +201,26 @@ EXPORT ToveTrianglesMode MeshGetIndexMode(ToveMeshRef mesh);
 EXPORT int MeshGetIndexCount(ToveMeshRef mesh);
 EXPORT void MeshCopyIndexData(
 	ToveMeshRef mesh, void *buffer, int32_t size);
+EXPORT int MeshGetUnmaskedIndexCount(ToveMeshRef mesh);
+EXPORT void MeshCopyUnmaskedIndexData(
+	ToveMeshRef mesh, void *buffer, int32_t size);
+EXPORT void MeshSetPathVisible(ToveMeshRef mesh, int path, bool visible);
+EXPORT bool MeshIsPathVisible(ToveMeshRef mesh, int path);
+EXPORT bool MeshGetPathRange(ToveMeshRef mesh, int path, ToveMeshRange *range);
+EXPORT int MeshGetDrawRanges(ToveMeshRef mesh, ToveMeshRange *ranges, int maxRanges);
+EXPORT int MeshGetDirtyRanges(ToveMeshRef mesh,
+	ToveByteRange *ranges, int maxRanges, uint32_t *indexVersion);
+EXPORT int MeshGetSubmeshIndices(ToveMeshRef mesh,
+	ToveSubmeshIndices *submeshes, int maxSubmeshes);
+EXPORT void MeshClearDirtyRanges(ToveMeshRef mesh);
 EXPORT void MeshCacheKeyFrame(ToveMeshRef mesh);
 EXPORT void MeshSetCacheSize(ToveMeshRef mesh, int size);
 EXPORT void ReleaseMesh(ToveMeshRef mesh);
 
 EXPORT void ConfigureShaderCode(ToveShaderLanguage language, int matrixRows);
 EXPORT const char *GetPaintShaderCode(int numPaints, int numGradients);
+EXPORT const char *GetGPUXAtlasShaderCode(
+	const ToveGPUXAtlasData *data, int numPaints, int numGradients);
 
 EXPORT ToveShaderCode GetGPUXFillShaderCode(
 	const ToveShaderData *data, bool fragLine, bool meshBand, bool debug);
@@ -181,6 +228,7 @@ EXPORT ToveShaderCode GetGPUXLineShaderCode(const ToveShaderData *data);
 
 EXPORT ToveTesselatorRef NewAdaptiveTesselator(float resolution, int recursionLimit);
 EXPORT ToveTesselatorRef NewRigidTesselator(int subdivisions);
+EXPORT ToveTesselatorRef NewRigidTesselatorWithTolerance(int subdivisions, float tolerance);
 EXPORT ToveTesselatorRef NewAntiGrainTesselator(const AntiGrainSettings *settings);
 EXPORT ToveMeshUpdateFlags TesselatorTessGraphics(ToveTesselatorRef tess,
 	ToveGraphicsRef graphics, ToveMeshRef mesh, ToveMeshUpdateFlags flags);
@@ -199,3 +247,40 @@ EXPORT void ReleaseName(ToveNameRef name);
 EXPORT ToveNameRef CloneName(ToveNameRef name);
 EXPORT void NameSet(ToveNameRef name, const char *s);
 EXPORT const char *NameCStr(ToveNameRef name);
+
+EXPORT ToveSnapshotRef NewGraphicsSnapshot(ToveGraphicsRef graphics);
+EXPORT uint32_t SnapshotGetVersion(ToveSnapshotRef snapshot);
+EXPORT void ReleaseSnapshot(ToveSnapshotRef snapshot);
+
+EXPORT void SetNumJobThreads(int numThreads);
+EXPORT ToveJobRef TesselatorTessGraphicsAsync(ToveTesselatorRef tess,
+	ToveGraphicsRef graphics, ToveMeshRef mesh, ToveMeshUpdateFlags flags);
+EXPORT ToveJobRef TesselatorTessSnapshotAsync(ToveTesselatorRef tess,
+	ToveSnapshotRef snapshot, ToveMeshRef mesh, ToveMeshUpdateFlags flags);
+EXPORT ToveJobRef GraphicsRasterizeAsync(
+	ToveGraphicsRef graphics, uint8_t *pixels, int width, int height, int stride,
+	float tx, float ty, float scale, const ToveRasterizeSettings *settings);
+EXPORT ToveJobRef SnapshotRasterizeAsync(
+	ToveSnapshotRef snapshot, uint8_t *pixels, int width, int height, int stride,
+	float tx, float ty, float scale, const ToveRasterizeSettings *settings);
+EXPORT ToveJobRef NewGraphicsAsync(const char *svg, const char* units, float dpi);
+EXPORT ToveJobStatus JobGetStatus(ToveJobRef job);
+EXPORT ToveJobStatus JobWait(ToveJobRef job);
+EXPORT ToveMeshUpdateFlags JobGetMeshUpdateFlags(ToveJobRef job);
+EXPORT ToveGraphicsRef JobGetGraphics(ToveJobRef job);
+EXPORT void ReleaseJob(ToveJobRef job);
+
+EXPORT void SetTraceEnabled(bool enabled);
+EXPORT void ClearTrace();
+EXPORT const char *GetTraceJSON();
+
+EXPORT void GetStats(ToveStats *stats);
+EXPORT void ResetStats();
+EXPORT void GraphicsGetStats(ToveGraphicsRef graphics, ToveStats *stats);
+EXPORT void GraphicsResetStats(ToveGraphicsRef graphics);
+
+EXPORT void GraphicsGetMemoryUsage(ToveGraphicsRef graphics, ToveMemoryUsage *usage);
+EXPORT void MeshGetMemoryUsage(ToveMeshRef mesh, ToveMemoryUsage *usage);
+EXPORT void FeedGetMemoryUsage(ToveFeedRef link, ToveMemoryUsage *usage);
+EXPORT void GraphicsCompact(ToveGraphicsRef graphics);
+EXPORT void MeshCompact(ToveMeshRef mesh);
@@ -26,6 +26,27 @@ typedef enum {
 	TRIANGLES_STRIP
 } ToveTrianglesMode;
 
+typedef struct {
+	int32_t vertexStart;
+	int32_t vertexCount;
+	int32_t indexStart;
+	int32_t indexCount;
+} ToveMeshRange;
+
+typedef struct {
+	uint32_t offset;
+	uint32_t size;
+} ToveByteRange;
+
+typedef struct {
+	int32_t path;
+	int32_t submesh; // 0 or 1, in paint order
+	uint32_t indexVersion;
+	int32_t indexStart; // into the unmasked index data
+	int32_t indexCount;
+	bool dirty; // changed or moved since MeshClearDirtyRanges
+} ToveSubmeshIndices;
+
 typedef enum {
 	TOVE_GLSL2,
 	TOVE_GLSL3
@@ -82,6 +103,48 @@ typedef enum {
 	TOVE_HANDLE_ALIGNED
 } ToveHandle;
 
+typedef enum {
+	TOVE_MORPH_LCM,
+	TOVE_MORPH_MINIMAL
+} ToveMorphStrategy;
+
+// new timelines use TOVE_TIMELINE_BOUNCE. in TOVE_TIMELINE_LOOP, the
+// last keyframe is followed by the first; splines pass smoothly through
+// that point only if both keyframes have the same points.
+
+typedef enum {
+	TOVE_TIMELINE_ONCE,
+	TOVE_TIMELINE_LOOP,
+	TOVE_TIMELINE_BOUNCE
+} ToveTimelineMode;
+
+typedef enum {
+	TOVE_INTERPOLATE_LINEAR,
+	TOVE_INTERPOLATE_CATMULL_ROM,
+	TOVE_INTERPOLATE_HERMITE
+} ToveInterpolation;
+
+typedef enum {
+	TOVE_EASE_LINEAR,
+	TOVE_EASE_IN_QUAD,
+	TOVE_EASE_OUT_QUAD,
+	TOVE_EASE_IN_OUT_QUAD,
+	TOVE_EASE_IN_CUBIC,
+	TOVE_EASE_OUT_CUBIC,
+	TOVE_EASE_IN_OUT_CUBIC,
+	TOVE_EASE_IN_SINE,
+	TOVE_EASE_OUT_SINE,
+	TOVE_EASE_IN_OUT_SINE,
+	TOVE_EASE_STEP
+} ToveEasing;
+
+typedef enum {
+	TOVE_JOB_PENDING,
+	TOVE_JOB_RUNNING,
+	TOVE_JOB_DONE,
+	TOVE_JOB_FAILED
+} ToveJobStatus;
+
 enum {
 	CHANGED_FILL_STYLE = 1,
 	CHANGED_LINE_STYLE = 2,
@@ -143,6 +206,18 @@ typedef struct {
 	void *ptr;
 } ToveNameRef;
 
+typedef struct {
+	void *ptr;
+} ToveTimelineRef;
+
+typedef struct {
+	void *ptr;
+} ToveSnapshotRef;
+
+typedef struct {
+	void *ptr;
+} ToveJobRef;
+
 typedef enum {
 	TOVE_REC_DEPTH,
 	TOVE_ANTIGRAIN,
@@ -194,6 +269,23 @@ typedef struct {
 	} quality;
 } ToveRasterizeSettings;
 
+typedef struct {
+	int numFrames;
+	int columns;
+	int rows;
+	int frameWidth;
+	int frameHeight;
+	int padding;
+	int width;
+	int height;
+} ToveAtlasLayout;
+
+typedef struct {
+	float t;
+	float u0, v0;
+	float u1, v1;
+} ToveAtlasFrame;
+
 typedef struct {
 	float r, g, b, a;
 } ToveRGBA;
@@ -261,6 +353,11 @@ typedef struct {
 	int16_t size;
 } TovePaintDataArray;
 
+typedef enum {
+	TOVE_GPUX_BANDS, // per-axis bands with binary search lookup
+	TOVE_GPUX_GRID // uniform grid of cells with per-cell curve lists
+} ToveGPUXAcceleration;
+
 typedef struct {
 	int n[2]; // number of used lookup table elements for x and y
 	int bsearch; // number of needed (compound) bsearch iterations
@@ -299,6 +396,8 @@ typedef struct {
 	int listsTextureRowBytes;
 	int listsTextureSize[2];
 	const char *listsTextureFormat;
+	int8_t listsIndexSize; // bytes per curve index (1 or 2)
+	int16_t gridSize; // grid cells per axis, or 0 if using bands
 
 	tove_gpu_float_t *curvesTexture;
 	int curvesTextureRowBytes;
@@ -317,6 +416,38 @@ typedef struct {
 	bool hasNormalFillStrokeOrder;
 } ToveShaderData;
 
+// only fills go into the atlas; strokes need to be drawn separately
+// (e.g. as meshes) after it, so a path's stroke cannot sit between
+// the fills of other paths, i.e. paint order is kept among fills only.
+
+typedef struct {
+	int32_t numPaths;
+	int32_t numCurves;
+
+	// one quad (6 vertices) per path; each vertex is x, y, path index
+	// (floats) followed by 4 paint index bytes (see PaintMesh).
+	uint8_t *vertices;
+	int16_t vertexStride;
+	int32_t numVertices;
+
+	// one row per path: (bounds), (curves row, lists row, grid size, fill rule).
+	float *headerTexture;
+	int headerTextureRowBytes;
+	int headerTextureSize[2];
+	const char *headerTextureFormat;
+
+	uint8_t *listsTexture;
+	int listsTextureRowBytes;
+	int listsTextureSize[2];
+	const char *listsTextureFormat;
+	int8_t listsIndexSize; // bytes per curve index (1 or 2)
+
+	tove_gpu_float_t *curvesTexture;
+	int curvesTextureRowBytes;
+	int curvesTextureSize[2];
+	const char *curvesTextureFormat;
+} ToveGPUXAtlasData;
+
 typedef struct {
 	void *ptr;
 } ToveFeedRef;
@@ -353,3 +484,32 @@ typedef struct {
 	uint32_t id; // >= 1
 	uint32_t version;
 } ToveSendArgs;
+
+typedef struct {
+	// counts since the last ResetStats(). these are doubles, not
+	// uint64_t, so that LuaJIT unboxes them into plain numbers.
+
+	double curvesFlattened;
+	double verticesEmitted;
+	double triangulationsCached; // found in a TriangleCache
+	double triangulationsComputed;
+	double clipperOperations;
+	double lutRebuilds; // GPUX lookup tables and grids
+	double pixelsRasterized;
+	double observerBroadcasts; // once per change or edit, not per observer; global only
+	double bytesUploaded; // mesh vertex and index data; global only
+} ToveStats;
+
+typedef struct {
+	// heap memory in bytes, by category. buffers that are shared between
+	// copy-on-write clones are counted for each of them.
+
+	double points; // subpath points and derived curve data
+	double nsvg; // NSVG mirrors of images, shapes and paths
+	double paints; // gradient records
+	double vertices; // owned vertex buffers
+	double triangles; // current index data and triangulation scratch
+	double triangulationCache; // cached triangulations and partitions
+	double geometry; // GPUX textures, lookup tables and color ramps
+	double reclaimable; // part of the above that a Compact call frees
+} ToveMemoryUsage;
@@ -0,0 +1,302 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "jobs.h"
+#include "snapshot.h"
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <vector>
+
+BEGIN_TOVE_NAMESPACE
+
+namespace {
+
+class JobQueue {
+	std::mutex mutex;
+	std::condition_variable available;
+	std::deque<JobRef> queue;
+	std::vector<JobRef> retired;
+	std::vector<std::thread> threads;
+	int numThreads;
+	bool stopping;
+
+	void work() {
+		while (true) {
+			JobRef job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				available.wait(lock, [this] () {
+					return stopping || !queue.empty();
+				});
+				if (queue.empty()) {
+					return;
+				}
+				job = queue.front();
+				queue.pop_front();
+			}
+			job->run();
+
+			// a job's snapshot shares paints (and their observers) with
+			// the main thread's objects, so it must also be freed there.
+			std::lock_guard<std::mutex> lock(mutex);
+			retired.push_back(std::move(job));
+		}
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		available.notify_all();
+		for (auto &thread : threads) {
+			thread.join();
+		}
+		threads.clear();
+		stopping = false;
+	}
+
+public:
+	JobQueue() : numThreads(0), stopping(false) {
+	}
+
+	void submit(const JobRef &job) {
+		collect();
+
+		if (threads.empty()) {
+			int n = numThreads;
+			if (n < 1) {
+				n = std::max(1u, std::thread::hardware_concurrency());
+			}
+			threads.reserve(n);
+			for (int i = 0; i < n; i++) {
+				threads.emplace_back(&JobQueue::work, this);
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.push_back(job);
+		}
+		available.notify_one();
+	}
+
+	void setNumThreads(int n) {
+		// pending jobs are finished by the current workers first.
+		stop();
+		collect();
+		numThreads = std::max(0, n);
+	}
+
+	// frees finished jobs; may only be called from the main thread.
+	void collect() {
+		std::vector<JobRef> jobs;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.swap(retired);
+		}
+	}
+
+	// like the pools, the queue lives until the process ends, so that
+	// its workers never get joined during static destruction.
+	static JobQueue &get() {
+		static JobQueue *queue = new JobQueue();
+		return *queue;
+	}
+};
+
+class TesselationJob : public AbstractJob {
+	const TesselatorRef tesselator;
+	const SnapshotRef snapshot;
+	const MeshRef mesh;
+	const ToveMeshUpdateFlags flags;
+	ToveMeshUpdateFlags updated;
+
+protected:
+	virtual void execute() {
+		updated = snapshot->tesselate(tesselator, mesh, flags);
+	}
+
+public:
+	TesselationJob(
+		const TesselatorRef &tesselator,
+		const SnapshotRef &snapshot,
+		const MeshRef &mesh,
+		ToveMeshUpdateFlags flags) :
+
+		tesselator(tesselator),
+		snapshot(snapshot),
+		mesh(mesh),
+		flags(flags),
+		updated(0) {
+	}
+
+	virtual ToveMeshUpdateFlags getUpdateFlags() const {
+		return updated;
+	}
+};
+
+class RasterizationJob : public AbstractJob {
+	const SnapshotRef snapshot;
+	uint8_t * const pixels;
+	const int width;
+	const int height;
+	const int stride;
+	const float tx;
+	const float ty;
+	const float scale;
+	const bool hasSettings;
+	ToveRasterizeSettings settings;
+
+protected:
+	virtual void execute() {
+		snapshot->rasterize(pixels, width, height, stride,
+			tx, ty, scale, hasSettings ? &settings : nullptr);
+	}
+
+public:
+	RasterizationJob(
+		const SnapshotRef &snapshot,
+		uint8_t *pixels,
+		int width, int height, int stride,
+		float tx, float ty, float scale,
+		const ToveRasterizeSettings *settings) :
+
+		snapshot(snapshot),
+		pixels(pixels),
+		width(width),
+		height(height),
+		stride(stride),
+		tx(tx),
+		ty(ty),
+		scale(scale),
+		hasSettings(settings != nullptr) {
+
+		if (settings) {
+			this->settings = *settings;
+		}
+	}
+};
+
+class ParseJob : public AbstractJob {
+	const std::string svg;
+	const std::string units;
+	const float dpi;
+	GraphicsRef graphics;
+
+protected:
+	virtual void execute() {
+		graphics = Graphics::createFromSVG(
+			svg.c_str(), units.c_str(), dpi);
+	}
+
+public:
+	ParseJob(const char *svg, const char *units, float dpi) :
+		svg(svg), units(units), dpi(dpi) {
+	}
+
+	virtual GraphicsRef getGraphics() const {
+		return graphics;
+	}
+};
+
+inline JobRef submit(const JobRef &job) {
+	JobQueue::get().submit(job);
+	return job;
+}
+
+} // namespace
+
+AbstractJob::AbstractJob() : status(TOVE_JOB_PENDING) {
+}
+
+void AbstractJob::run() {
+	status = TOVE_JOB_RUNNING;
+
+	report::deferred = &reports;
+	ToveJobStatus result = TOVE_JOB_DONE;
+	try {
+		execute();
+	} catch (const std::bad_alloc&) {
+		result = TOVE_JOB_FAILED;
+	} catch (...) {
+		report::report("job failed with an unknown error", TOVE_REPORT_ERR);
+		result = TOVE_JOB_FAILED;
+	}
+	report::deferred = nullptr;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		status = result;
+	}
+	finished.notify_all();
+}
+
+void AbstractJob::deliverReports() {
+	for (const auto &r : reports) {
+		report::report(r.first.c_str(), r.second);
+	}
+	reports.clear();
+}
+
+ToveJobStatus AbstractJob::getStatus() {
+	const ToveJobStatus s = ToveJobStatus(status.load());
+	if (s >= TOVE_JOB_DONE) {
+		deliverReports();
+		JobQueue::get().collect();
+	}
+	return s;
+}
+
+ToveJobStatus AbstractJob::wait() {
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this] () {
+			return status >= TOVE_JOB_DONE;
+		});
+	}
+	deliverReports();
+	JobQueue::get().collect();
+	return ToveJobStatus(status.load());
+}
+
+JobRef submitTesselation(
+	const TesselatorRef &tesselator,
+	const SnapshotRef &snapshot,
+	const MeshRef &mesh,
+	ToveMeshUpdateFlags flags) {
+
+	return submit(tove_make_shared<TesselationJob>(
+		tesselator, snapshot, mesh, flags));
+}
+
+JobRef submitRasterization(
+	const SnapshotRef &snapshot,
+	uint8_t *pixels,
+	int width, int height, int stride,
+	float tx, float ty, float scale,
+	const ToveRasterizeSettings *settings) {
+
+	return submit(tove_make_shared<RasterizationJob>(
+		snapshot, pixels, width, height, stride,
+		tx, ty, scale, settings));
+}
+
+JobRef submitParse(const char *svg, const char *units, float dpi) {
+	return submit(tove_make_shared<ParseJob>(svg, units, dpi));
+}
+
+void setNumJobThreads(int numThreads) {
+	JobQueue::get().setNumThreads(numThreads);
+}
+
+END_TOVE_NAMESPACE
@@ -0,0 +1,80 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_JOBS
+#define __TOVE_JOBS 1
+
+#include "common.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+BEGIN_TOVE_NAMESPACE
+
+// a unit of work that runs on one of the library's worker threads. jobs
+// only ever see data that is immutable (snapshots, see snapshot.h) or
+// that the caller promised not to touch until the job is done (meshes,
+// pixel buffers).
+
+class AbstractJob : public Referencable {
+private:
+	std::atomic<int> status;
+	std::mutex mutex;
+	std::condition_variable finished;
+	report::Deferred reports;
+
+	void deliverReports();
+
+protected:
+	virtual void execute() = 0;
+
+public:
+	AbstractJob();
+
+	virtual ~AbstractJob() {
+	}
+
+	void run();
+
+	// both of these may only be called from the main thread.
+	ToveJobStatus getStatus();
+	ToveJobStatus wait();
+
+	virtual ToveMeshUpdateFlags getUpdateFlags() const {
+		return 0;
+	}
+
+	virtual GraphicsRef getGraphics() const {
+		return GraphicsRef();
+	}
+};
+
+JobRef submitTesselation(
+	const TesselatorRef &tesselator,
+	const SnapshotRef &snapshot,
+	const MeshRef &mesh,
+	ToveMeshUpdateFlags flags);
+
+JobRef submitRasterization(
+	const SnapshotRef &snapshot,
+	uint8_t *pixels,
+	int width, int height, int stride,
+	float tx, float ty, float scale,
+	const ToveRasterizeSettings *settings);
+
+JobRef submitParse(const char *svg, const char *units, float dpi);
+
+// 0 picks the number of hardware threads.
+void setNumJobThreads(int numThreads);
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_JOBS
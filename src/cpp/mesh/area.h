@@ -14,6 +14,7 @@
 
 #include <vector>
 #include "utils.h"
+#include "../footprint.h"
 
 BEGIN_TOVE_NAMESPACE
 
@@ -76,6 +77,14 @@ public:
 	void clear() {
 		indices.clear();
 	}
+
+	void release() {
+		footprint::release(indices);
+	}
+
+	inline void addMemoryUsage(double &category, ToveMemoryUsage &usage) const {
+		footprint::add(category, usage, indices);
+	}
 };
 
 // fast, SIMD-able computation of areas
@@ -16,6 +16,7 @@
 #include "turtle.h"
 #include "../path.h"
 #include "../subpath.h"
+#include "../stats.h"
 
 BEGIN_TOVE_NAMESPACE
 
@@ -378,10 +379,14 @@ void AbstractAdaptiveFlattener::flatten(
 
 	const int n = path->getNumSubpaths();
 	bool closed = true;
-	for (int i = 0; i < n; i++) {
-		const auto subpath = path->getSubpath(i);
-		tesselation.fill.push_back(flatten(subpath));
-		closed = closed && subpath->isClosed();
+	{
+		TOVE_TRACE_ZONE("flatten");
+		stats::count(stats::CURVES_FLATTENED, path->getNumCurves());
+		for (int i = 0; i < n; i++) {
+			const auto subpath = path->getSubpath(i);
+			tesselation.fill.push_back(flatten(subpath));
+			closed = closed && subpath->isClosed();
+		}
 	}
 
 	NSVGshape * const shape = &path->nsvg;
@@ -395,9 +400,15 @@ void AbstractAdaptiveFlattener::flatten(
 		lines = computeDashes(shape, tesselation.fill);
 	}
 
-	ClipperLib::SimplifyPolygons(tesselation.fill, fillType);
+	{
+		TOVE_TRACE_ZONE("clipper.simplify");
+		stats::count(stats::CLIPPER_OPERATIONS);
+		ClipperLib::SimplifyPolygons(tesselation.fill, fillType);
+	}
 
 	if (hasStroke) {
+		TOVE_TRACE_ZONE("clipper.offset");
+
 		float lineOffset = shape->strokeWidth * clipper.scale * 0.5f;
 		if (lineOffset < 1.0f) {
 			// scaled offsets < 1 will generate artefacts as the ClipperLib's
@@ -406,6 +417,7 @@ void AbstractAdaptiveFlattener::flatten(
 			tove::report::warn("ignoring line width < 2. please use setResolution().");
 		}
 
+		stats::count(stats::CLIPPER_OPERATIONS);
 		ClipperLib::ClipperOffset offset(
 			shape->miterLimit, clipper.arcTolerance);
 		offset.AddPaths(lines,
@@ -418,6 +430,7 @@ void AbstractAdaptiveFlattener::flatten(
 		ClipperLib::ClosedPathsFromPolyTree(tesselation.stroke, stroke);
 
 		if (path->hasNormalFillStrokeOrder()) {
+			stats::count(stats::CLIPPER_OPERATIONS);
 			ClipperLib::Clipper clipper;
 			clipper.AddPaths(tesselation.fill, ClipperLib::ptSubject, true);
 			clipper.AddPaths(stroke, ClipperLib::ptClip, true);
@@ -430,11 +443,11 @@ void AbstractAdaptiveFlattener::flatten(
 
 int RigidFlattener::flatten(
 	const Vertices &vertices,
-	int index, int level,
+	int index, int level, int depth,
 	float x1, float y1, float x2, float y2,
 	float x3, float y3, float x4, float y4) const
 {
-	if (level >= _depth) {
+	if (level >= depth) {
 		auto &v = vertices[index++];
 		if (_offset != 0.0) {
 			float dx = x4 - x1;
@@ -465,18 +478,55 @@ int RigidFlattener::flatten(
 	x1234 = (x123+x234)*0.5f;
 	y1234 = (y123+y234)*0.5f;
 
-	index = flatten(vertices, index, level+1,
+	index = flatten(vertices, index, level+1, depth,
 		x1,y1, x12,y12, x123,y123, x1234,y1234);
-	index = flatten(vertices, index, level+1,
+	index = flatten(vertices, index, level+1, depth,
 		x1234,y1234, x234,y234, x34,y34, x4,y4);
 	return index;
 }
 
+int RigidFlattener::flattenLine(
+	const Vertices &vertices,
+	int index, int depth,
+	float x1, float y1, float x4, float y4) const
+{
+	// same vertices as flatten() produces for a line, without recursion.
+	const int n = 1 << depth;
+	const float dx = x4 - x1;
+	const float dy = y4 - y1;
+
+	float ox = 0.0f;
+	float oy = 0.0f;
+	if (_offset != 0.0) {
+		const float s = _offset / sqrt(dx * dx + dy * dy);
+		ox = -s * dy;
+		oy = s * dx;
+	}
+
+	for (int i = 1; i <= n; i++) {
+		auto &v = vertices[index++];
+		const float t = float(i) / n;
+		v.x = x1 + t * dx + ox;
+		v.y = y1 + t * dy + oy;
+	}
+
+	return index;
+}
 
 int RigidFlattener::size(const SubpathRef &subpath) const {
 	const NSVGpath *path = &subpath->nsvg;
 	const int npts = path->npts;
 	const int n = ncurves(npts);
+
+	if (_tolerance > 0.0f && n > 0) {
+		const uint8_t *levels = subpath->getSubdivisionLevels(_depth, _tolerance);
+		int size = 1;
+		for (int i = 0; i < n; i++) {
+			size += 1 << levels[i];
+		}
+		return size;
+	}
+
 	const int verticesPerCurve = (1 << _depth);
 	return 1 + n * verticesPerCurve;
 }
@@ -484,6 +534,8 @@ int RigidFlattener::size(const SubpathRef &subpath) const {
 int RigidFlattener::flatten(
 	const SubpathRef &subpath, const MeshRef &mesh, int index) const {
 
+	TOVE_TRACE_ZONE("flatten");
+
 	const NSVGpath *path = &subpath->nsvg;
 	const int npts = path->npts;
 
@@ -493,9 +545,13 @@ int RigidFlattener::flatten(
 
 	const int n = ncurves(npts);
 
-	const int verticesPerCurve = (1 << _depth);
-	const int numVertices = 1 + n * verticesPerCurve;
+	const uint8_t *levels = _tolerance > 0.0f ?
+		subpath->getSubdivisionLevels(_depth, _tolerance) : nullptr;
+
+	const int numVertices = size(subpath);
 	const auto vertices = mesh->vertices(index, numVertices);
+	stats::count(stats::CURVES_FLATTENED, n);
+	stats::count(stats::VERTICES_EMITTED, numVertices);
 
 	vertices[0].x = path->pts[0];
 	vertices[0].y = path->pts[1];
@@ -506,10 +562,15 @@ int RigidFlattener::flatten(
 		const float *p = &path->pts[k * 2];
 		k += 3;
 
+		const int depth = levels ? levels[i] : _depth;
 		const int v0 = v;
-		v = flatten(vertices, v, 0,
-			p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
-		assert(v - v0 == verticesPerCurve);
+		if (subpath->isLine(i)) {
+			v = flattenLine(vertices, v, depth, p[0], p[1], p[6], p[7]);
+		} else {
+			v = flatten(vertices, v, 0, depth,
+				p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
+		}
+		assert(v - v0 == (1 << depth));
 	}
 
 	assert(v == numVertices);
@@ -145,6 +145,12 @@ protected:
 		for (int i = 0; i * 2 + 7 < path->npts * 2; i += 3) {
 			const float *p = &path->pts[i * 2];
 
+			if (subpath->isLine(i / 3)) {
+				result.push_back(ClipperPoint(p[0] * scale, p[1] * scale));
+				result.push_back(ClipperPoint(p[6] * scale, p[7] * scale));
+				continue;
+			}
+
 			flatten(
 				p[0] * scale, p[1] * scale,
 				p[2] * scale, p[3] * scale,
@@ -174,20 +180,29 @@ class RigidFlattener {
 private:
 	const int _depth;
 	const float _offset;
+	const float _tolerance;
 
 	int flatten(
 		const Vertices &vertices,
-		int index, int level,
+		int index, int level, int depth,
 		float x1, float y1, float x2, float y2,
 		float x3, float y3, float x4, float y4) const;
 
+	int flattenLine(
+		const Vertices &vertices,
+		int index, int depth,
+		float x1, float y1, float x4, float y4) const;
+
 public:
 	int size(const SubpathRef &subpath) const;
 	int flatten(const SubpathRef &subpath, const MeshRef &mesh, int index) const;
 
-	inline RigidFlattener(int subdivisions, float offset) :
+	// with a tolerance > 0, each curve gets its own subdivision level
+	// (up to subdivisions), see Subpath::getSubdivisionLevels().
+	inline RigidFlattener(int subdivisions, float offset, float tolerance = 0.0f) :
 		_depth(std::min(toveMaxFlattenSubdivisions, subdivisions)),
-		_offset(offset) {
+		_offset(offset),
+		_tolerance(tolerance) {
 	}
 };
 
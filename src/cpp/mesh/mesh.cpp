@@ -12,6 +12,8 @@
 #include "../common.h"
 #include "mesh.h"
 #include "../path.h"
+#include "../graphics.h"
+#include "../stats.h"
 #if TOVE_DEBUG
 #include <iostream>
 #endif
@@ -51,9 +53,13 @@ inline void triangulationFailed(const std::list<TPPLPoly> &polys) {
 AbstractMesh::AbstractMesh(const NameRef &name, uint16_t stride) :
 	mVertices(nullptr),
 	mVertexCount(0),
+	mCapacity(0),
 	mOwnsBuffer(true),
 	mName(name),
-	mStride(stride) {
+	mStride(stride),
+	mIndexVersion(0),
+	mSource(0),
+	mSourceVersion(0) {
 }
 
 AbstractMesh::~AbstractMesh() {
@@ -74,22 +80,30 @@ ToveTrianglesMode AbstractMesh::getIndexMode() const {
 	}
 }
 
-int32_t AbstractMesh::getIndexCount() const {
+int32_t AbstractMesh::getIndexCount(bool masked) const {
 	int32_t k = 0;
 	for (auto submesh : mSubmeshes) {
-		k += submesh.second->getIndexCount();
+		if (!masked || isPathVisible(submesh.first / 2)) {
+			k += submesh.second->getIndexCount();
+		}
 	}
 	return k;
 }
 
 void AbstractMesh::copyIndexData(
 	ToveVertexIndex *indices,
-	int32_t indexCount) const {
+	int32_t indexCount,
+	bool masked) const {
+
+	stats::count(stats::BYTES_UPLOADED, indexCount * sizeof(ToveVertexIndex));
 
 	const int n = mSubmeshes.size();
 	if (n == 1) {
-		mSubmeshes.begin()->second->copyIndexData(
-			indices, indexCount);
+		const auto submesh = mSubmeshes.begin();
+		if (!masked || isPathVisible(submesh->first / 2)) {
+			submesh->second->copyIndexData(
+				indices, indexCount);
+		}
 	} else {
 		// subtle point: mSubmeshes needs to be ordered (e.g.
 		// a map here) otherwise our triangle order would be
@@ -97,6 +111,9 @@ void AbstractMesh::copyIndexData(
 
 		int32_t offset = 0;
 		for (auto submesh : mSubmeshes) {
+			if (masked && !isPathVisible(submesh.first / 2)) {
+				continue;
+			}
 			Submesh *m = submesh.second;
 			m->copyIndexData(
 				indices + offset, indexCount - offset);
@@ -105,6 +122,99 @@ void AbstractMesh::copyIndexData(
 	}
 }
 
+void AbstractMesh::setPathVisible(int pathIndex, bool visible) {
+	if (pathIndex < 0) {
+		return;
+	}
+	if (pathIndex >= int(mHiddenPaths.size())) {
+		if (visible) {
+			return;
+		}
+		mHiddenPaths.resize(pathIndex + 1, false);
+	}
+	if (mHiddenPaths[pathIndex] != !visible) {
+		mHiddenPaths[pathIndex] = !visible;
+		indicesChanged();
+	}
+}
+
+bool AbstractMesh::getPathRange(int pathIndex, ToveMeshRange &range) const {
+	int32_t index = 0;
+	bool found = false;
+
+	for (auto submesh : mSubmeshes) {
+		const Submesh *m = submesh.second;
+		const int32_t count = m->getIndexCount();
+
+		if (int(submesh.first / 2) == pathIndex) {
+			const int32_t v0 = m->getVertexStart();
+			const int32_t v1 = v0 + m->getVertexCount();
+			if (!found) {
+				range.vertexStart = v0;
+				range.vertexCount = v1 - v0;
+				range.indexStart = index;
+				range.indexCount = count;
+				found = true;
+			} else {
+				const int32_t start = std::min(range.vertexStart, v0);
+				range.vertexCount = std::max(
+					range.vertexStart + range.vertexCount, v1) - start;
+				range.vertexStart = start;
+				range.indexCount += count;
+			}
+		} else if (found) {
+			break;
+		}
+
+		index += count;
+	}
+
+	return found;
+}
+
+int AbstractMesh::getDrawRanges(ToveMeshRange *ranges, int maxRanges) const {
+	int32_t index = 0;
+	int32_t end = -1;
+	int n = 0;
+
+	for (auto submesh : mSubmeshes) {
+		const Submesh *m = submesh.second;
+		const int32_t count = m->getIndexCount();
+
+		if (count > 0 && isPathVisible(submesh.first / 2)) {
+			const int32_t v0 = m->getVertexStart();
+			const int32_t v1 = v0 + m->getVertexCount();
+
+			if (index == end) {
+				if (n <= maxRanges) {
+					ToveMeshRange &r = ranges[n - 1];
+					const int32_t start = std::min(r.vertexStart, v0);
+					r.vertexCount = std::max(
+						r.vertexStart + r.vertexCount, v1) - start;
+					r.vertexStart = start;
+					r.indexCount += count;
+				}
+			} else {
+				if (n < maxRanges) {
+					ToveMeshRange &r = ranges[n];
+					r.vertexStart = v0;
+					r.vertexCount = v1 - v0;
+					r.indexStart = index;
+					r.indexCount = count;
+				}
+				n++;
+			}
+
+			end = index + count;
+		}
+
+		index += count;
+	}
+
+	// returns the number of ranges needed, which might exceed maxRanges.
+	return n;
+}
+
 void AbstractMesh::setNewExternalVertexBuffer(
 	void *buffer,
 	size_t bufferByteSize) {
@@ -123,7 +233,113 @@ void AbstractMesh::setNewExternalVertexBuffer(
 
 	mVertices = buffer;
 	mVertexCount = bufferByteSize / mStride;
+	mCapacity = 0;
 	mOwnsBuffer = false;
+
+	addDirtyVertices(0, mVertexCount);
+}
+
+void AbstractMesh::addDirtyVertices(int32_t begin, int32_t end) {
+	// keep a small number of coalesced ranges. since paths are
+	// written in order, most updates just extend an existing range.
+	for (auto &r : mDirtyVertices) {
+		if (begin <= r.second && end >= r.first) {
+			r.first = std::min(r.first, begin);
+			r.second = std::max(r.second, end);
+			return;
+		}
+	}
+
+	if (mDirtyVertices.size() >= 16) {
+		for (const auto &r : mDirtyVertices) {
+			begin = std::min(begin, r.first);
+			end = std::max(end, r.second);
+		}
+		mDirtyVertices.clear();
+	}
+
+	mDirtyVertices.emplace_back(begin, end);
+}
+
+int AbstractMesh::getDirtyRanges(ToveByteRange *ranges, int maxRanges) {
+	std::sort(mDirtyVertices.begin(), mDirtyVertices.end());
+
+	int n = 0;
+	int32_t end = -1;
+	for (const auto &r : mDirtyVertices) {
+		const int32_t first = std::min(r.first, mVertexCount);
+		const int32_t last = std::min(r.second, mVertexCount);
+		if (first >= last) {
+			continue;
+		}
+
+		if (first <= end) {
+			// overlaps or touches the previous range.
+			if (last > end) {
+				if (n <= maxRanges) {
+					ranges[n - 1].size += (last - end) * mStride;
+				}
+				end = last;
+			}
+		} else {
+			if (n < maxRanges) {
+				ranges[n].offset = first * mStride;
+				ranges[n].size = (last - first) * mStride;
+			}
+			n++;
+			end = last;
+		}
+	}
+
+	if (n <= maxRanges) {
+		// the caller now has all ranges and is going to upload them.
+		uint32_t size = 0;
+		for (int i = 0; i < n; i++) {
+			size += ranges[i].size;
+		}
+		stats::count(stats::BYTES_UPLOADED, size);
+	}
+
+	// returns the number of ranges needed, which might exceed maxRanges.
+	return n;
+}
+
+int AbstractMesh::getSubmeshIndices(
+	ToveSubmeshIndices *submeshes, int maxSubmeshes) const {
+
+	int32_t index = 0;
+	int n = 0;
+
+	for (auto submesh : mSubmeshes) {
+		const Submesh *m = submesh.second;
+		const int32_t count = m->getIndexCount();
+
+		if (n < maxSubmeshes) {
+			ToveSubmeshIndices &s = submeshes[n];
+			s.path = submesh.first / 2;
+			s.submesh = submesh.first % 2;
+			s.indexVersion = m->getIndexVersion();
+			s.indexStart = index;
+			s.indexCount = count;
+			s.dirty = m->isIndexDirty(index);
+		}
+		n++;
+
+		index += count;
+	}
+
+	// returns the number of submeshes, which might exceed maxSubmeshes.
+	return n;
+}
+
+void AbstractMesh::clearDirty() {
+	mDirtyVertices.clear();
+
+	int32_t index = 0;
+	for (auto submesh : mSubmeshes) {
+		submesh.second->setIndexClean(index);
+		index += submesh.second->getIndexCount();
+	}
 }
 
 void AbstractMesh::reserve(int32_t n) {
@@ -140,10 +356,11 @@ void AbstractMesh::reserve(int32_t n) {
 		}
 
 		mVertexCount = n;
+		mCapacity = nextpow2(mVertexCount);
 
 	    mVertices = realloc(
 	    	mVertices,
-			nextpow2(mVertexCount) * mStride);
+			mCapacity * mStride);
 
 		if (!mVertices) {
 			TOVE_FATAL("out of memory during vertex allocation");
@@ -156,6 +373,75 @@ void AbstractMesh::reserve(int32_t n) {
 	}
 }
 
+void AbstractMesh::addMemoryUsage(ToveMemoryUsage &usage) const {
+	if (mOwnsBuffer && mVertices) {
+		footprint::add(usage.vertices, usage,
+			mVertexCount * mStride, mCapacity * mStride);
+	}
+	for (const auto &submesh : mSubmeshes) {
+		submesh.second->addMemoryUsage(usage);
+	}
+	footprint::add(usage.vertices, usage, mDirtyVertices);
+}
+
+void AbstractMesh::compact() {
+	if (mOwnsBuffer && mVertices && mCapacity != mVertexCount) {
+		if (mVertexCount == 0) {
+			free(mVertices);
+			mVertices = nullptr;
+			mCapacity = 0;
+		} else {
+			void *vertices = realloc(mVertices, mVertexCount * mStride);
+			if (vertices) { // otherwise keep the larger block.
+				mVertices = vertices;
+				mCapacity = mVertexCount;
+			}
+		}
+	}
+	for (const auto &submesh : mSubmeshes) {
+		submesh.second->compact();
+	}
+	mDirtyVertices.shrink_to_fit();
+}
+
+void AbstractMesh::setSource(const Graphics *graphics) {
+	mSource = graphics ? graphics->getId() : 0;
+	mSourceVersion = graphics ? graphics->getVersion() : 0;
+}
+
+bool AbstractMesh::getSourceTransform(
+	const Graphics *graphics, float *matrix) const {
+
+	if (mSource != graphics->getId() || mSourceVersion == graphics->getVersion()) {
+		return false;
+	}
+	return graphics->getTransformSince(mSourceVersion, matrix);
+}
+
+void AbstractMesh::transformVertices(
+	const float *matrix, const Graphics *graphics) {
+
+	const float t0 = matrix[0];
+	const float t1 = matrix[1];
+	const float t2 = matrix[2];
+	const float t3 = matrix[3];
+	const float t4 = matrix[4];
+	const float t5 = matrix[5];
+
+	const Vertices v(mVertices, mStride);
+	const int n = mVertexCount;
+	addDirtyVertices(0, n);
+	for (int i = 0; i < n; i++) {
+		vec2 &p = v[i];
+		const float x = p.x;
+		const float y = p.y;
+		p.x = x * t0 + y * t2 + t4;
+		p.y = x * t1 + y * t3 + t5;
+	}
+
+	setSource(graphics);
+}
+
 void AbstractMesh::cacheKeyFrame() {
 	for (auto submesh : mSubmeshes) {
 		submesh.second->cacheKeyFrame();
@@ -172,12 +458,14 @@ void AbstractMesh::clear(bool ensureOwnBuffer) {
 	mVertexCount = 0;
 	if (ensureOwnBuffer && !mOwnsBuffer) {
 		mVertices = nullptr;
+		mCapacity = 0;
 		mOwnsBuffer = true;
 	}
 	for (auto submesh : mSubmeshes) {
 		delete submesh.second;
 	}
 	mSubmeshes.clear();
+	indicesChanged();
 }
 
 void AbstractMesh::clearTriangles() {
@@ -198,6 +486,17 @@ void Submesh::addClipperPaths(
 	const ClipperPaths &paths,
 	float scale) {
 
+	TOVE_TRACE_ZONE("triangulate");
+	stats::count(stats::TRIANGULATIONS_COMPUTED);
+
+	int numVertices = 0;
+	for (const ClipperPath &path : paths) {
+		numVertices += path.size();
+	}
+	stats::count(stats::VERTICES_EMITTED, numVertices);
+
+	indicesChanged();
+
 #if DEBUG_EARCUT
 	using Point = std::array<float, 2>;
 	std::vector<std::vector<Point>> polygon;
@@ -273,6 +572,7 @@ void Submesh::addClipperPaths(
 
 void Submesh::clearTriangles() {
 	mTriangles.clear();
+	indicesChanged();
 }
 
 static void stripRangeToList(
@@ -359,16 +659,19 @@ static uint16_t *reducedOverlapTriangles(
 
 void Submesh::triangulateFixedResolutionLine(
 	const int pathVertex,
-	const bool miter,
+	const int joinVertices,
 	const bool reduceOverlap,
 	const int verticesPerSegment,
 	const PathRef &path,
 	const RigidFlattener &flattener) {
 
+	TOVE_TRACE_ZONE("triangulate.line");
+
 	const int numSubpaths = path->getNumSubpaths();
 	int subpathVertex = ToLoveVertexMapIndex(pathVertex);
 
 	mTriangles.clear();
+	indicesChanged();
 
 	for (int t = 0; t < numSubpaths; t++) {
 		const int numVertices = path->getSubpathSize(t, flattener);
@@ -376,10 +679,15 @@ void Submesh::triangulateFixedResolutionLine(
 			tove::report::warn("cannot render line with less than 2 vertices.");
 		} else {
 			const bool closed = path->getSubpath(t)->isClosed();
-			const bool skipped = !closed && miter ? 1 : 0;
+
+			// open lines skip their first join. with fan joins, that
+			// slot and the one after the last segment hold the caps.
+			const bool caps = !closed && joinVertices > 1;
+			const int skipped = !closed && !caps ? joinVertices : 0;
 
 			const int numSegments = numVertices - (closed ? 0 : 1);
-			const int numIndices = verticesPerSegment * numSegments - skipped;
+			const int numIndices = verticesPerSegment * numSegments - skipped +
+				(caps ? joinVertices : 0);
 
 			const int firstIndex = subpathVertex + skipped;
 
@@ -410,7 +718,8 @@ void Submesh::triangulateFixedResolutionLine(
 				uint16_t *data = mTriangles.allocate(TRIANGLES_LIST, n);
 
 				uint16_t *end = reducedOverlapTriangles(
-					subpathVertex, numVertices, miter, closed, verticesPerSegment, data);
+					subpathVertex, numVertices, joinVertices == 1, closed,
+					verticesPerSegment, data);
 
 				assert((end - data) == n * 3);
 #else
@@ -444,7 +753,11 @@ void Submesh::triangulateFixedResolutionFill(
 	const PathRef &path,
 	const RigidFlattener &flattener) {
 
+	TOVE_TRACE_ZONE("triangulate");
+	stats::count(stats::TRIANGULATIONS_COMPUTED);
+
 	const int numSubpaths = path->getNumSubpaths();
+	indicesChanged();
 
 #if DEBUG_EARCUT
 	using Point = std::array<float, 2>;
@@ -454,7 +767,7 @@ void Submesh::triangulateFixedResolutionFill(
 
 	for (int i = 0; i < numSubpaths; i++) {
 		const int n = path->getSubpathSize(i, flattener);
-		const auto vertex = vertices(vertexIndex, n);
+		const auto vertex = mMesh->readVertices(vertexIndex);
 		vertexIndex += n;
 
 		std::vector<Point> subpath;
@@ -507,7 +820,7 @@ void Submesh::triangulateFixedResolutionFill(
 			continue;
 		}
 
-	   	const auto vertex = vertices(vertexIndex, n);
+	   	const auto vertex = mMesh->readVertices(vertexIndex);
 
 		mCleaner.clear();
 		for (int j = 0; j < n; j++) {
@@ -521,8 +834,12 @@ void Submesh::triangulateFixedResolutionFill(
 			mCleaner, vertexMap, clipperScale));
 	}
 
-	ClipperLib::SimplifyPolygons(
-		clipperPaths, path->getClipperFillType());
+	{
+		TOVE_TRACE_ZONE("clipper.simplify");
+		stats::count(stats::CLIPPER_OPERATIONS);
+		ClipperLib::SimplifyPolygons(
+			clipperPaths, path->getClipperFillType());
+	}
 
 	std::list<TPPLPoly> polys;
 
@@ -599,6 +916,7 @@ Submesh *AbstractMesh::submesh(int pathIndex, int line) {
 	} else {
 		Submesh *submesh = new Submesh(this);
 		mSubmeshes[id] = submesh;
+		indicesChanged();
 		return submesh;
 	}
 }
@@ -55,14 +55,28 @@ class AbstractMesh : public Referencable {
 protected:
 	void *mVertices;
 	int32_t mVertexCount;
+	int32_t mCapacity; // of an owned mVertices, in vertices
 	bool mOwnsBuffer;
 
 	const NameRef mName;
 	const uint16_t mStride;
 
 	std::map<SubmeshId, Submesh*> mSubmeshes;
+	std::vector<bool> mHiddenPaths;
+
+	// vertex index ranges [first, second) written since the last call
+	// to clearDirty(), and a version that changes with the index data.
+	std::vector<std::pair<int32_t, int32_t>> mDirtyVertices;
+	uint32_t mIndexVersion;
+
+	void addDirtyVertices(int32_t begin, int32_t end);
 	mutable std::vector<ToveVertexIndex> mCoalescedTriangles;
 
+	// id and version of the graphics our vertices were computed from
+	// (0 if none); see Graphics::getId().
+	uint64_t mSource;
+	uint32_t mSourceVersion;
+
 	void reserve(int32_t n);
 
 	void setNewExternalVertexBuffer(
@@ -74,11 +88,28 @@ public:
 
 	ToveTrianglesMode getIndexMode() const;
 
-	int32_t getIndexCount() const;
+	// by default, index data excludes all triangles of hidden paths.
+	int32_t getIndexCount(bool masked = true) const;
 
 	void copyIndexData(
 		ToveVertexIndex *indices,
-		int32_t indexCount) const;
+		int32_t indexCount,
+		bool masked = true) const;
+
+	void setPathVisible(int pathIndex, bool visible);
+
+	inline bool isPathVisible(int pathIndex) const {
+		return pathIndex < 0 || pathIndex >= int(mHiddenPaths.size()) ||
+			!mHiddenPaths[pathIndex];
+	}
+
+	// vertex and index ranges of one path; index ranges refer to
+	// the unmasked index data.
+	bool getPathRange(int pathIndex, ToveMeshRange &range) const;
+
+	// index ranges (into the unmasked index data) that cover all
+	// visible paths; adjacent ranges get merged.
+	int getDrawRanges(ToveMeshRange *ranges, int maxRanges) const;
 
 	inline void clip(int n) {
 		mVertexCount = std::min(mVertexCount, n);
@@ -88,9 +119,32 @@ public:
 		if (from + n > mVertexCount) {
 			reserve(from + n);
 		}
+		addDirtyVertices(from, from + n);
+		return Vertices(mVertices, mStride, from);
+	}
+
+	// access to vertices for reading only; does not mark them dirty.
+	inline Vertices readVertices(int from) const {
+		assert(from <= mVertexCount);
 		return Vertices(mVertices, mStride, from);
 	}
 
+	inline void indicesChanged() {
+		mIndexVersion++;
+	}
+
+	inline uint32_t getIndexVersion() const {
+		return mIndexVersion;
+	}
+
+	int getDirtyRanges(ToveByteRange *ranges, int maxRanges);
+
+	// index version and range of each submesh, and whether these
+	// changed since the last clearDirty().
+	int getSubmeshIndices(ToveSubmeshIndices *submeshes, int maxSubmeshes) const;
+
+	void clearDirty();
+
 	void cacheKeyFrame();
 	void setCacheSize(int size);
 	void clear(bool ensureOwnBuffer = false);
@@ -125,9 +179,20 @@ public:
 
 	Submesh *submesh(int pathIndex, int line);
 
+	void setSource(const Graphics *graphics);
+
+	bool getSourceTransform(const Graphics *graphics, float *matrix) const;
+	void transformVertices(const float *matrix, const Graphics *graphics);
+
 	inline const NameRef &getName() const {
 		return mName;
 	}
+
+	// external vertex buffers are not counted, as the caller owns them.
+	void addMemoryUsage(ToveMemoryUsage &usage) const;
+
+	// trims vertex and index buffers to their current size.
+	void compact();
 };
 
 class Submesh {
@@ -135,11 +200,56 @@ private:
 	AbstractMesh * const mMesh;
 	TriangleCache mTriangles;
 	SubpathCleaner mCleaner;
+	int32_t mVertexStart;
+	int32_t mVertexCount;
+	uint32_t mIndexVersion;
+
+	// index version and start as of the last AbstractMesh::clearDirty(),
+	// with a start of -1 if that has not happened yet.
+	uint32_t mCleanIndexVersion;
+	int32_t mCleanIndexStart;
+
+	inline void indicesChanged() {
+		mIndexVersion++;
+		mMesh->indicesChanged();
+	}
 
 public:
 	inline Submesh(AbstractMesh *mesh) :
 		mMesh(mesh),
-		mTriangles(mesh->getName()) {
+		mTriangles(mesh->getName()),
+		mVertexStart(0),
+		mVertexCount(0),
+		mIndexVersion(0),
+		mCleanIndexVersion(0),
+		mCleanIndexStart(-1) {
+	}
+
+	inline uint32_t getIndexVersion() const {
+		return mIndexVersion;
+	}
+
+	inline bool isIndexDirty(int32_t indexStart) const {
+		return mCleanIndexVersion != mIndexVersion ||
+			mCleanIndexStart != indexStart;
+	}
+
+	inline void setIndexClean(int32_t indexStart) {
+		mCleanIndexVersion = mIndexVersion;
+		mCleanIndexStart = indexStart;
+	}
+
+	inline void setVertexRange(int32_t start, int32_t count) {
+		mVertexStart = start;
+		mVertexCount = count;
+	}
+
+	inline int32_t getVertexStart() const {
+		return mVertexStart;
+	}
+
+	inline int32_t getVertexCount() const {
+		return mVertexCount;
 	}
 
 	inline ToveTrianglesMode getIndexMode() const {
@@ -161,6 +271,16 @@ public:
 	void setCacheSize(int size);
 	void clearTriangles();
 
+	inline void addMemoryUsage(ToveMemoryUsage &usage) const {
+		mTriangles.addMemoryUsage(usage);
+		mCleaner.addMemoryUsage(usage.triangles, usage);
+	}
+
+	inline void compact() {
+		mTriangles.compact();
+		mCleaner.release();
+	}
+
 	inline Vertices vertices(int from, int n) {
 		return mMesh->vertices(from, n);
 	}
@@ -177,7 +297,7 @@ public:
 		const RigidFlattener &flattener);
 	void triangulateFixedResolutionLine(
 		const int pathVertex,
-		const bool miter,
+		const int joinVertices,
 		const bool reduceOverlap,
 		const int verticesPerSegment,
 		const PathRef &path,
@@ -185,10 +305,15 @@ public:
 
 	inline bool findCachedTriangulation(
 		bool &trianglesChanged) {
-		
-		return mTriangles.findCachedTriangulation(
-			vertices(0, mMesh->getVertexCount()),
-			trianglesChanged);
+
+		bool changed = false;
+		const bool found = mTriangles.findCachedTriangulation(
+			mMesh->readVertices(0), changed);
+		if (changed) {
+			trianglesChanged = true;
+			indicesChanged();
+		}
+		return found;
 	}
 
 	inline const NameRef &getName() const {
@@ -12,6 +12,7 @@
 #include "../common.h"
 #include "meshifier.h"
 #include "mesh.h"
+#include "../stats.h"
 #include <sstream>
 #include <chrono>
 
@@ -34,8 +35,45 @@ ToveMeshUpdateFlags AbstractTesselator::graphicsToMesh(
 	const MeshRef &fill,
 	const MeshRef &line) {
 
+	stats::Attribution attribution(graphics->getCounters());
 	const int n = graphics->getNumPaths();
 
+	ToveMeshUpdateFlags transformed = 0;
+
+	if (update & UPDATE_MESH_VERTICES) {
+		// if graphics only underwent affine transforms since we last
+		// built our meshes, transform their vertices and keep triangles.
+		// any other requested updates (colors, triangles) still happen
+		// below; as non-fixed size meshes are always rebuilt as a whole,
+		// those only get the shortcut if nothing else was requested.
+
+		const ToveMeshUpdateFlags rest =
+			update & (UPDATE_MESH_COLORS | UPDATE_MESH_TRIANGLES);
+
+		const bool compound = fill.get() == line.get();
+		float fillMatrix[6];
+		float lineMatrix[6];
+
+		if ((rest == 0 || hasFixedSize()) &&
+			fill->getSourceTransform(graphics, fillMatrix) &&
+			acceptsTransform(fillMatrix) &&
+			(compound || (line->getSourceTransform(graphics, lineMatrix) &&
+				acceptsTransform(lineMatrix)))) {
+
+			fill->transformVertices(fillMatrix, graphics);
+			if (!compound) {
+				line->transformVertices(lineMatrix, graphics);
+			}
+
+			if (rest == 0) {
+				return UPDATE_MESH_VERTICES;
+			}
+
+			transformed = UPDATE_MESH_VERTICES;
+			update = rest;
+		}
+	}
+
 	if (!hasFixedSize()) {
 		fill->clear(true);
 		line->clear(true);
@@ -70,12 +108,17 @@ ToveMeshUpdateFlags AbstractTesselator::graphicsToMesh(
 
 	endTesselate();
 
-	return updated;
+	if (!hasFixedSize() || (update & UPDATE_MESH_VERTICES)) {
+		fill->setSource(graphics);
+		line->setSource(graphics);
+	}
+
+	return updated | transformed;
 }
 
 
 static void clip(
-	const Graphics *graphics,
+	const std::vector<ClipperPaths> &clipPaths,
 	const PathRef &path,
 	ClipperPaths &subject) {
 
@@ -84,14 +127,16 @@ static void clip(
 		path->getClipIndices();
 
 	if (!clipIndices.empty()) {
+		TOVE_TRACE_ZONE("clipper.clip");
 		for (TOVEclipPathIndex i : clipIndices) {
+			stats::count(stats::CLIPPER_OPERATIONS);
 			ClipperLib::Clipper c;
 			c.AddPaths(
 				subject,
 				ClipperLib::ptSubject,
 				true);
 			c.AddPaths(
-				graphics->getClipAtIndex(i)->computed,
+				clipPaths.at(i),
 				ClipperLib::ptClip,
 				true);
 			c.Execute(
@@ -119,13 +164,22 @@ void AdaptiveTesselator::beginTesselate(
 
 	flattener->configure(scale);
 
-	graphics->computeClipPaths(*this);
+	graphics->computeClipPaths(*this, clipPaths);
 }
 
 bool AdaptiveTesselator::hasFixedSize() const {
 	return false;
 }
 
+bool AdaptiveTesselator::acceptsTransform(const float *matrix) const {
+	// flattening resolution depends on scale; only allow scales that
+	// stay within a small tolerance of the current resolution.
+	const float tolerance = 0.02f;
+	const float sx = std::sqrt(matrix[0] * matrix[0] + matrix[1] * matrix[1]);
+	const float sy = std::sqrt(matrix[2] * matrix[2] + matrix[3] * matrix[3]);
+	return std::abs(sx - 1.0f) <= tolerance && std::abs(sy - 1.0f) <= tolerance;
+}
+
 void AdaptiveTesselator::renderStrokes(
 	const PathRef &path,
 	const ClipperLib::PolyNode *node,
@@ -147,7 +201,7 @@ void AdaptiveTesselator::renderStrokes(
 			ClipperPaths paths;
 			paths.push_back(node->Contour);
 			paths.insert(paths.end(), holes.begin(), holes.end());
-			clip(graphics, path, paths);
+			clip(clipPaths, path, paths);
 			submesh->addClipperPaths(
 				paths, flattener->getClipperScale());
 		}
@@ -189,11 +243,13 @@ ToveMeshUpdateFlags AdaptiveTesselator::pathToMesh(
 			case NSVG_PAINTORDER_FILL: {
 				if (!t.fill.empty() && shape->fill.type != NSVG_PAINT_NONE) {
 
-					clip(graphics, path, t.fill);
+					clip(clipPaths, path, t.fill);
 
 					const int index0 = fill->getVertexCount();
-					fill->submesh(pathIndex, subMeshIndex)->addClipperPaths(
+					Submesh *submesh = fill->submesh(pathIndex, subMeshIndex);
+					submesh->addClipperPaths(
 						t.fill, flattener->getClipperScale());
+					submesh->setVertexRange(index0, fill->getVertexCount() - index0);
 					fill->setFillColor(path, paint, index0, fill->getVertexCount() - index0);
 				}
 
@@ -206,7 +262,9 @@ ToveMeshUpdateFlags AdaptiveTesselator::pathToMesh(
 
 					const int index0 = line->getVertexCount();
 					ClipperPaths holes;
-					renderStrokes(path, &t.stroke, holes, line->submesh(pathIndex, subMeshIndex));
+					Submesh *submesh = line->submesh(pathIndex, subMeshIndex);
+					renderStrokes(path, &t.stroke, holes, submesh);
+					submesh->setVertexRange(index0, line->getVertexCount() - index0);
 					line->setLineColor(path, paint, index0, line->getVertexCount() - index0);
 				}
 
@@ -233,8 +291,12 @@ ClipperLib::Paths AdaptiveTesselator::toClipPath(
 	for (const PathRef &path : paths) {
 		Tesselation t;
 		flattener->flatten(path, t);
-		ClipperLib::SimplifyPolygons(
-			t.fill, path->getClipperFillType());
+		{
+			TOVE_TRACE_ZONE("clipper.simplify");
+			stats::count(stats::CLIPPER_OPERATIONS);
+			ClipperLib::SimplifyPolygons(
+				t.fill, path->getClipperFillType());
+		}
 
 		if (paths.size() == 1) {
 			return t.fill;
@@ -248,9 +310,126 @@ ClipperLib::Paths AdaptiveTesselator::toClipPath(
 	return flattened;
 }
 
-RigidTesselator::RigidTesselator(int subdivisions) :
+// round joins and caps in rigid line meshes get the same number of
+// vertices at every joint, so that the mesh layout does not depend on
+// the current points. they are laid out as a fan of (center, outline)
+// pairs inside the line's triangle strip; all outline points lie on or
+// inside the stroke's extent around the center.
+
+static const int numRoundJoinSteps = 4;
+static const int numFanJoinVertices = 2 * (numRoundJoinSteps + 1);
+
+static int roundArc(vec2 *points, float cx, float cy, float ux, float uy, float angle) {
+	const float c = std::cos(angle / numRoundJoinSteps);
+	const float s = std::sin(angle / numRoundJoinSteps);
+	for (int i = 0; i <= numRoundJoinSteps; i++) {
+		points[i] = vec2(cx + ux, cy + uy);
+		const float t = ux * c - uy * s;
+		uy = ux * s + uy * c;
+		ux = t;
+	}
+	return numRoundJoinSteps + 1;
+}
+
+static void fanJoin(
+	Vertices &out,
+	const float x0, const float y0,
+	const float x1, const float y1,
+	const float dx21, const float dy21,
+	const float lineOffset,
+	const ToveLineJoin join,
+	const ToveLineCap cap,
+	const int capAt, // -1 for start cap, 1 for end cap, 0 for join
+	const float miterLimitSquared) {
+
+	vec2 points[numRoundJoinSteps + 1];
+	int n;
+
+	float dx10 = x1 - x0;
+	float dy10 = y1 - y0;
+	const float d10 = std::sqrt(dx10 * dx10 + dy10 * dy10);
+	if (d10 > 0.0f) {
+		dx10 /= d10;
+		dy10 /= d10;
+	} else {
+		dx10 = dx21;
+		dy10 = dy21;
+	}
+
+	if (capAt != 0) {
+		// u is the offset to the side where the outline starts,
+		// e is the offset along the path away from the line.
+		float ux, uy, ex, ey;
+		if (capAt < 0) {
+			ux = dy21 * lineOffset;
+			uy = -dx21 * lineOffset;
+			ex = -dx21 * lineOffset;
+			ey = -dy21 * lineOffset;
+		} else {
+			ux = -dy10 * lineOffset;
+			uy = dx10 * lineOffset;
+			ex = dx10 * lineOffset;
+			ey = dy10 * lineOffset;
+		}
+
+		switch (cap) {
+			case TOVE_LINECAP_ROUND: {
+				n = roundArc(points, x1, y1, ux, uy, -M_PI);
+			} break;
+			case TOVE_LINECAP_SQUARE: {
+				points[0] = vec2(x1 + ux, y1 + uy);
+				points[1] = vec2(x1 + ux + ex, y1 + uy + ey);
+				points[2] = vec2(x1 - ux + ex, y1 - uy + ey);
+				points[3] = vec2(x1 - ux, y1 - uy);
+				n = 4;
+			} break;
+			default: {
+				points[0] = vec2(x1 + ux, y1 + uy);
+				points[1] = vec2(x1 - ux, y1 - uy);
+				n = 2;
+			} break;
+		}
+	} else {
+		const float n10x = -dy10;
+		const float n10y = dx10;
+
+		const float n21x = -dy21;
+		const float n21y = dx21;
+
+		const float wind = -n21y * n10x - n21x * -n10y;
+		const float side = std::copysign(1.0f, wind) * lineOffset;
+
+		points[0] = vec2(x1 + n10x * side, y1 + n10y * side);
+
+		if (join == TOVE_LINEJOIN_ROUND) {
+			n = roundArc(points, x1, y1, n10x * side, n10y * side,
+				vec2(n10x, n10y).angle(vec2(n21x, n21y)));
+		} else {
+			n = 1;
+
+			const float mx = (n10x + n21x) * 0.5f;
+			const float my = (n10y + n21y) * 0.5f;
+
+			if (join == TOVE_LINEJOIN_MITER &&
+				(mx * mx + my * my) * miterLimitSquared >= 1.0f) {
+				const float l = side / (mx * n10x + my * n10y);
+				points[n++] = vec2(x1 + l * mx, y1 + l * my);
+			}
+
+			points[n++] = vec2(x1 + n21x * side, y1 + n21y * side);
+		}
+	}
+
+	// pad unused pairs with degenerate triangles.
+	for (int i = 0; i <= numRoundJoinSteps; i++) {
+		*out++ = vec2(x1, y1);
+		*out++ = points[std::min(i, n - 1)];
+	}
+}
+
+RigidTesselator::RigidTesselator(int subdivisions, float tolerance) :
 
-	flattener(subdivisions, 0.0) {
+	flattener(subdivisions, 0.0, tolerance) {
 }
 
 ToveMeshUpdateFlags RigidTesselator::pathToMesh(
@@ -307,12 +486,25 @@ ToveMeshUpdateFlags RigidTesselator::pathToMesh(
 	ToveMeshUpdateFlags update = _update;
 	bool trianglesChanged = false;
 
+	const ToveLineJoin lineJoin = path->getLineJoin();
+	const ToveLineCap lineCap = path->getLineCap();
 	const float miterLimit = path->getMiterLimit();
-	const bool miter = path->getLineJoin() == TOVE_LINEJOIN_MITER &&
+	const bool miter = lineJoin == TOVE_LINEJOIN_MITER &&
 		miterLimit > 0.0f;
 	const bool reduceOverlap = false;
 
-	const int verticesPerSegment = 4 + (miter ? 1 : 0) + (reduceOverlap ? 1 : 0);
+	bool open = false;
+	for (int i = 0; i < n; i++) {
+		open = open || !path->getSubpath(i)->isClosed();
+	}
+
+	// round joins and non-butt caps need a fan of vertices at each joint;
+	// otherwise we get along with one (miter) or no (bevel) extra vertex.
+	const bool fanJoins = lineJoin == TOVE_LINEJOIN_ROUND ||
+		(open && lineCap != TOVE_LINECAP_BUTT);
+	const int joinVertices = fanJoins ? numFanJoinVertices : (miter ? 1 : 0);
+
+	const int verticesPerSegment = 4 + joinVertices + (reduceOverlap ? 1 : 0);
 
 	// in case of stroke-only paths, we still produce the fill vertices for
 	// computing the stroke vertices, but then skip fill triangulation.
@@ -333,7 +525,7 @@ ToveMeshUpdateFlags RigidTesselator::pathToMesh(
 			}
 
 			if (hasStroke) {
-				// const bool closed = path->getSubpath(i)->isClosed();
+				const bool closed = path->getSubpath(i)->isClosed();
 				const float miterLimitSquared = miterLimit * miterLimit;
 
 				// note: for compound mode, the call to fill->vertices
@@ -342,6 +534,7 @@ ToveMeshUpdateFlags RigidTesselator::pathToMesh(
 
 				const int subpathLineVertex = lineIndex0 + lineBase + index * verticesPerSegment;
 				auto out = line->vertices(subpathLineVertex, k * verticesPerSegment);
+				stats::count(stats::VERTICES_EMITTED, k * verticesPerSegment);
 
 				const auto vertices = fill->vertices(
 					fillIndex0 + index, k);
@@ -390,7 +583,12 @@ ToveMeshUpdateFlags RigidTesselator::pathToMesh(
 					const float ox = -dy21 * lineOffset;
 					const float oy = dx21 * lineOffset;
 	
-					if (miter) {
+					if (fanJoins) {
+						const int capAt = closed ? 0 :
+							(j == 0 ? -1 : (j == k - 1 ? 1 : 0));
+						fanJoin(out, x0, y0, x1, y1, dx21, dy21, lineOffset,
+							lineJoin, lineCap, capAt, miterLimitSquared);
+					} else if (miter) {
 						float dx10 = x1 - x0;
 						float dy10 = y1 - y0;
 						const float d10 = std::sqrt(dx10 * dx10 + dy10 * dy10);
@@ -487,7 +685,7 @@ ToveMeshUpdateFlags RigidTesselator::pathToMesh(
 
 		if (update & UPDATE_MESH_TRIANGLES) {
 			lineSubmesh->triangulateFixedResolutionLine(
-				v0, miter, reduceOverlap, verticesPerSegment, path, flattener);
+				v0, joinVertices, reduceOverlap, verticesPerSegment, path, flattener);
 		}
 		if (update & (UPDATE_MESH_COLORS | UPDATE_MESH_VERTICES)) {
 			line->setLineColor(path, paint, v0, index * verticesPerSegment);
@@ -498,6 +696,10 @@ ToveMeshUpdateFlags RigidTesselator::pathToMesh(
 		update |= UPDATE_MESH_TRIANGLES;
 	}
 
+	fillSubmesh->setVertexRange(fillIndex0, index);
+	lineSubmesh->setVertexRange(
+		lineIndex0 + lineBase, hasStroke ? index * verticesPerSegment : 0);
+
 	lineIndex = lineIndex0 + lineBase + index * verticesPerSegment;
 	fillIndex = compound ? lineIndex : fillIndex0 + index;
 
@@ -49,6 +49,10 @@ public:
 
 	virtual bool hasFixedSize() const = 0;
 
+	virtual bool acceptsTransform(const float *matrix) const {
+		return true;
+	}
+
 	inline AbstractTesselator() : graphics(nullptr) {
 	}
 
@@ -66,6 +70,9 @@ private:
 
 	AbstractAdaptiveFlattener *flattener;
 
+	// flattened clip paths of the graphics being tesselated.
+	std::vector<ClipperPaths> clipPaths;
+
 public:
 	AdaptiveTesselator(
 		AbstractAdaptiveFlattener *flattener);
@@ -90,6 +97,8 @@ public:
 		const std::vector<PathRef> &paths) const;
 
 	virtual bool hasFixedSize() const;
+
+	virtual bool acceptsTransform(const float *matrix) const;
 };
 
 class RigidTesselator : public AbstractTesselator {
@@ -97,7 +106,7 @@ private:
 	const RigidFlattener flattener;
 
 public:
-	RigidTesselator(int subdivisions);
+	RigidTesselator(int subdivisions, float tolerance = 0.0f);
 
 	virtual ToveMeshUpdateFlags pathToMesh(
 		ToveMeshUpdateFlags update,
@@ -14,6 +14,7 @@
 
 #include "../common.h"
 #include "utils.h"
+#include "../footprint.h"
 #include <vector>
 
 BEGIN_TOVE_NAMESPACE
@@ -41,6 +42,14 @@ public:
 	}
 
 	bool check(const Vertices &vertices);
+
+	inline void addMemoryUsage(double &category, ToveMemoryUsage &usage) const {
+		footprint::add(category, usage, parts);
+		for (const Part &part : parts) {
+			footprint::add(category, usage, part.outline);
+		}
+		footprint::add(category, usage, tempPts);
+	}
 };
 
 END_TOVE_NAMESPACE
@@ -10,6 +10,7 @@
  */
 
 #include "triangles.h"
+#include "../stats.h"
 #include <sstream>
 #include <chrono>
 
@@ -26,9 +27,11 @@ ToveVertexIndex *TriangleStore::allocate(int n, bool isFinalSize) {
         mTriangles, count * sizeof(ToveVertexIndex)));
 
     if (!mTriangles) {
+        mCapacity = 0;
         TOVE_BAD_ALLOC();
         return nullptr;
     }
+    mCapacity = count;
 
     return &mTriangles[offset];
 }
@@ -84,6 +87,24 @@ void TriangleStore::_add(
     }
 }
 
+void TriangleStore::compact() {
+    if (mSize == mCapacity) {
+        return;
+    }
+    if (mSize == 0) {
+        free(mTriangles);
+        mTriangles = nullptr;
+        mCapacity = 0;
+        return;
+    }
+    ToveVertexIndex *triangles = static_cast<ToveVertexIndex*>(realloc(
+        mTriangles, mSize * sizeof(ToveVertexIndex)));
+    if (triangles) { // otherwise keep the larger block.
+        mTriangles = triangles;
+        mCapacity = mSize;
+    }
+}
+
 
 TriangleCache::~TriangleCache() {
     for (Triangulation *t : triangulations) {
@@ -128,7 +149,9 @@ void TriangleCache::evict() {
 bool TriangleCache::findCachedTriangulation(
     const Vertices &vertices,
     bool &trianglesChanged) {
-    
+
+    TOVE_TRACE_ZONE("triangles.cache");
+
     const int n = triangulations.size();
     if (n == 0) {
         return false;
@@ -158,6 +181,10 @@ bool TriangleCache::findCachedTriangulation(
         switchedTo += 1;
     }
 
+    if (good) {
+        stats::count(stats::TRIANGULATIONS_CACHED);
+    }
+
     if (debug) {
         std::ostringstream s;
         if (good) {
@@ -179,4 +206,19 @@ bool TriangleCache::findCachedTriangulation(
     return good;
 }
 
+void TriangleCache::addMemoryUsage(ToveMemoryUsage &usage) const {
+    bool current = true;
+    for (const Triangulation *t : triangulations) {
+        t->addMemoryUsage(current ?
+            usage.triangles : usage.triangulationCache, usage);
+        current = false;
+    }
+}
+
+void TriangleCache::compact() {
+    for (Triangulation *t : triangulations) {
+        t->triangles.compact();
+    }
+}
+
 END_TOVE_NAMESPACE
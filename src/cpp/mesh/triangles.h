@@ -16,6 +16,7 @@
 #include "area.h"
 #include "../interface.h"
 #include "../utils.h"
+#include "../footprint.h"
 
 BEGIN_TOVE_NAMESPACE
 
@@ -35,6 +36,7 @@ inline ToveVertexIndex ToLoveVertexMapIndex(ToveVertexIndex i) {
 class TriangleStore {
 private:
 	int32_t mSize;
+	int32_t mCapacity;
 	ToveVertexIndex *mTriangles;
 
 public:
@@ -54,7 +56,7 @@ private:
 
 public:
 	inline TriangleStore(ToveTrianglesMode mode) :
-		mSize(0), mTriangles(nullptr), mMode(mode) {
+		mSize(0), mCapacity(0), mTriangles(nullptr), mMode(mode) {
 	}
 
 	inline ~TriangleStore() {
@@ -64,7 +66,7 @@ public:
 	}
 
 	inline TriangleStore(const std::list<TPPLPoly> &triangles) :
-		mSize(0), mTriangles(nullptr), mMode(TRIANGLES_LIST) {
+		mSize(0), mCapacity(0), mTriangles(nullptr), mMode(TRIANGLES_LIST) {
 
 		_add(triangles, true);
 	}
@@ -91,6 +93,14 @@ public:
 		return mMode;
 	}
 
+	void compact();
+
+	inline void addMemoryUsage(double &category, ToveMemoryUsage &usage) const {
+		footprint::add(category, usage,
+			mSize * sizeof(ToveVertexIndex),
+			mCapacity * sizeof(ToveVertexIndex));
+	}
+
 	inline void copy(
 		ToveVertexIndex *indices,
 		int32_t indexCount) const {
@@ -127,6 +137,12 @@ struct Triangulation {
 		return vanishing.check(vertices) && partition.check(vertices);
 	}
 
+	inline void addMemoryUsage(double &category, ToveMemoryUsage &usage) const {
+		triangles.addMemoryUsage(category, usage);
+		partition.addMemoryUsage(category, usage);
+		vanishing.addMemoryUsage(category, usage);
+	}
+
 	Partition partition;
 	TriangleStore triangles;
 	uint64_t useCount;
@@ -240,6 +256,10 @@ public:
 
 	bool findCachedTriangulation(
 		const Vertices &vertices, bool &trianglesChanged);
+
+	// the current triangulation counts as index data, all others as cache.
+	void addMemoryUsage(ToveMemoryUsage &usage) const;
+	void compact();
 };
 
 END_TOVE_NAMESPACE
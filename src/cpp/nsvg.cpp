@@ -12,6 +12,7 @@
 #include "nsvg.h"
 #include "utils.h"
 #include "palette.h"
+#include "stats.h"
 
 #include "../thirdparty/robin-map/include/tsl/robin_map.h"
 #include "../thirdparty/tinyxml2/tinyxml2.h"
@@ -254,14 +255,30 @@ int parseSVG(
 } // bridge
 
 NSVGimage *parseSVG(const char *svg, const char *units, float dpi) {
+	TOVE_TRACE_ZONE("parse");
+
 	const NanoSVGEnvironment env;
 	// we know that our own bridge::parseSVG won't destroy the svg input
 	// text, so it's safe to const_cast here.
 	return nsvgParseEx(const_cast<char*>(svg), units, dpi, bridge::parseSVG);
 }
 
+namespace {
+struct RasterizerCleanup {
+	~RasterizerCleanup() {
+		// free this thread's rasterizer when worker threads exit.
+		if (rasterizer) {
+			nsvgDeleteRasterizer(rasterizer);
+			rasterizer = nullptr;
+		}
+	}
+};
+}
+
 static NSVGrasterizer *ensureRasterizer() {
 	if (!rasterizer) {
+		thread_local RasterizerCleanup cleanup;
+		(void)cleanup;
 		rasterizer = nsvgCreateRasterizer();
 	}
 	return rasterizer;
@@ -399,7 +416,13 @@ void xformIdentity(float *m) {
 	nsvg__xformIdentity(m);
 }
 
+void xformMultiply(float *t, const float *s) {
+	nsvg__xformMultiply(t, const_cast<float*>(s));
+}
+
 NSVGimage *parsePath(const char *d) {
+	TOVE_TRACE_ZONE("parse.path");
+
 	const NanoSVGEnvironment env;
 
 	NSVGparser *parser = getNSVGparser();
@@ -497,6 +520,9 @@ void rasterize(NSVGimage *image, float tx, float ty, float scale,
 	uint8_t* pixels, int width, int height, int stride,
 	const ToveRasterizeSettings *quality) {
 
+	TOVE_TRACE_ZONE("rasterize");
+	stats::count(stats::PIXELS_RASTERIZED, uint64_t(width) * height);
+
 	NSVGrasterizer *rasterizer = getRasterizer(quality);
 
 	nsvgRasterize(rasterizer, image, tx, ty, scale,
@@ -75,6 +75,7 @@ public:
 
 void xformInverse(float *a, float *b);
 void xformIdentity(float *m);
+void xformMultiply(float *t, const float *s);
 
 float *pathArcTo(float *cpx, float *cpy, float *args, int &npts);
 NSVGimage *parsePath(const char *d);
@@ -126,6 +127,10 @@ public:
 
 	float getScale() const;
 
+	inline const float *getMatrix() const {
+		return matrix;
+	}
+
 	inline bool isIdentity() const {
 		return identity;
 	}
@@ -13,7 +13,8 @@
 #define __TOVE_OBSERVER 1
 
 #include "common.h"
-#include <unordered_set>
+#include "stats.h"
+#include <vector>
 
 BEGIN_TOVE_NAMESPACE
 
@@ -26,10 +27,82 @@ public:
 
 	virtual void observableChanged(
         Observable *observable, ToveChangeFlags what) = 0;
+
+	// owners (a path of its subpaths and paints, a graphics of its
+	// paths) hear about changes at once, even during edits, so that
+	// their bounds and versions never go stale.
+	virtual bool isOwner() const {
+		return false;
+	}
+};
+
+// nearly all observables have one or two observers, so we keep these
+// inline and only go to the heap for larger sets.
+
+class ObserverSet {
+	enum {
+		INLINE_CAPACITY = 2
+	};
+
+	Observer *inlined[INLINE_CAPACITY];
+	std::vector<Observer*> spilled;
+	int count;
+
+public:
+	inline ObserverSet() : count(0) {
+	}
+
+	inline int size() const {
+		return count;
+	}
+
+	inline Observer * const *begin() const {
+		return spilled.empty() ? inlined : spilled.data();
+	}
+
+	inline Observer * const *end() const {
+		return begin() + count;
+	}
+
+	inline void insert(Observer *observer) {
+		for (Observer *o : *this) {
+			if (o == observer) {
+				return;
+			}
+		}
+		if (spilled.empty() && count < INLINE_CAPACITY) {
+			inlined[count] = observer;
+		} else {
+			if (spilled.empty()) {
+				spilled.assign(inlined, inlined + count);
+			}
+			spilled.push_back(observer);
+		}
+		count++;
+	}
+
+	inline void erase(Observer *observer) {
+		Observer **data = spilled.empty() ? inlined : spilled.data();
+		for (int i = 0; i < count; i++) {
+			if (data[i] == observer) {
+				data[i] = data[count - 1];
+				if (!spilled.empty()) {
+					spilled.pop_back();
+				}
+				count--;
+				return;
+			}
+		}
+	}
 };
 
 class Observable {
-	std::unordered_set<Observer*> observers;
+	ObserverSet observers;
+
+	// between beginEdit() and endEdit(), changes for observers that
+	// are not owners are collected here and then broadcast once.
+	ToveChangeFlags deferredChanges;
+	int editDepth;
 
 protected:
     inline bool hasObservers() const {
@@ -37,22 +110,53 @@ protected:
     }
 
 public:
+	inline Observable() : deferredChanges(0), editDepth(0) {
+	}
+
     virtual ~Observable() {
         assert(!hasObservers());
     }
 
 	inline void addObserver(Observer *observer) {
-        observers.insert(observer);        
+        observers.insert(observer);
     }
 	inline void removeObserver(Observer *observer) {
         observers.erase(observer);
     }
 
 	void broadcastChange(ToveChangeFlags what) {
-        for (Observer *observer : observers) {
-            observer->observableChanged(this, what);
-        }        
-    }
+		const stats::Cascade cascade(stats::OBSERVER_BROADCASTS);
+		if (editDepth > 0) {
+			deferredChanges |= what;
+		}
+		for (Observer *observer : observers) {
+			if (editDepth == 0 || observer->isOwner()) {
+				observer->observableChanged(this, what);
+			}
+		}
+	}
+
+	inline bool isEditing() const {
+		return editDepth > 0;
+	}
+
+	virtual void beginEdit() {
+		editDepth++;
+	}
+
+	virtual void endEdit() {
+		assert(editDepth > 0);
+		if (--editDepth == 0 && deferredChanges) {
+			const ToveChangeFlags what = deferredChanges;
+			deferredChanges = 0;
+			const stats::Cascade cascade(stats::OBSERVER_BROADCASTS);
+			for (Observer *observer : observers) {
+				if (!observer->isOwner()) {
+					observer->observableChanged(this, what);
+				}
+			}
+		}
+	}
 };
 
 END_TOVE_NAMESPACE
@@ -115,10 +115,14 @@ void AbstractGradient::sort() const {
 
 NSVGgradient *AbstractGradient::getInverseNSVGgradient() {
 	const size_t size = getRecordSize(nsvg->nstops);
-	nsvgInverse = static_cast<NSVGgradient*>(realloc(nsvgInverse, size));
-	if (!nsvgInverse) {
-		TOVE_BAD_ALLOC();
-		return nullptr;
+	// paths sharing this paint keep pointers to nsvgInverse in their
+	// NSVGpaint, so only move it if the number of stops changed.
+	if (!nsvgInverse || nsvgInverse->nstops != nsvg->nstops) {
+		nsvgInverse = static_cast<NSVGgradient*>(realloc(nsvgInverse, size));
+		if (!nsvgInverse) {
+			TOVE_BAD_ALLOC();
+			return nullptr;
+		}
 	}
 	std::memcpy(nsvgInverse, nsvg, size);
 	xformInverse.store(nsvgInverse->xform);
@@ -99,6 +99,9 @@ public:
 
 	virtual bool animate(const PaintRef &a, const PaintRef &b, float t) = 0;
 
+	virtual void addMemoryUsage(ToveMemoryUsage &usage) const {
+	}
+
 #if TOVE_DEBUG
 	virtual std::ostream &dump(std::ostream &os) = 0;
 #endif
@@ -250,6 +253,11 @@ public:
 
 	virtual bool animate(const PaintRef &a, const PaintRef &b, float t);
 
+	virtual void addMemoryUsage(ToveMemoryUsage &usage) const {
+		const size_t size = getRecordSize(nsvg->nstops);
+		usage.paints += nsvgInverse ? 2 * size : size;
+	}
+
 #if TOVE_DEBUG
 	virtual std::ostream &dump(std::ostream &os);
 #endif
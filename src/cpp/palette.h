@@ -63,10 +63,8 @@ private:
 #endif 
 
 public:
-    static Palette *deref(void *palette) {
-        // binding code for NanoSVG tove extensions.
-        return static_cast<PaletteRef*>(palette)->get();
-    }
+    // binding code for NanoSVG tove extensions.
+    static Palette *deref(void *palette);
 
     inline int size() const {
         return _size;
@@ -33,7 +33,7 @@ void Path::_append(const SubpathRef &trajectory) {
 	} else {
 		subpaths[subpaths.size() - 1]->setNext(trajectory);
 	}
-	trajectory->addObserver(this);
+	adopt(trajectory);
 	subpaths.push_back(trajectory);
 	if (fillColor) {
 		trajectory->setIsClosed(true);
@@ -41,7 +41,15 @@ void Path::_append(const SubpathRef &trajectory) {
 	changed(CHANGED_GEOMETRY);
 }
 
-void Path::_setFillColor(const PaintRef &color) {
+void Path::adopt(const SubpathRef &trajectory) {
+	trajectory->addObserver(this);
+	if (isEditing()) {
+		trajectory->beginEdit();
+		editingSubpaths.push_back(trajectory);
+	}
+}
+
+void Path::_setFillColor(const PaintRef &color, const NSVGpaint *stored) {
 	if (fillColor == color) {
 		return;
 	}
@@ -53,12 +61,17 @@ void Path::_setFillColor(const PaintRef &color) {
 	if (fillColor) {
 		fillColor->removeObserver(this);
 	}
+	fillColorShared = false;
 
 	fillColor = color;
 
 	if (color) {
 		color->addObserver(this);
-		color->store(nsvg.fill);
+		if (stored) {
+			nsvg.fill = *stored;
+		} else {
+			color->store(nsvg.fill);
+		}
 	} else {
 		nsvg.fill.type = NSVG_PAINT_NONE;
 	}
@@ -70,7 +83,7 @@ void Path::_setFillColor(const PaintRef &color) {
 	changed(CHANGED_FILL_STYLE);
 }
 
-void Path::_setLineColor(const PaintRef &color) {
+void Path::_setLineColor(const PaintRef &color, const NSVGpaint *stored) {
 	if (lineColor == color) {
 		return;
 	}
@@ -82,12 +95,17 @@ void Path::_setLineColor(const PaintRef &color) {
 	if (lineColor) {
 		lineColor->removeObserver(this);
 	}
+	lineColorShared = false;
 
 	lineColor = color;
 
 	if (color) {
 		color->addObserver(this);
-		color->store(nsvg.stroke);
+		if (stored) {
+			nsvg.stroke = *stored;
+		} else {
+			color->store(nsvg.stroke);
+		}
 	} else {
 		nsvg.stroke.type = NSVG_PAINT_NONE;
 	}
@@ -95,6 +113,26 @@ void Path::_setLineColor(const PaintRef &color) {
 	changed(CHANGED_LINE_STYLE);
 }
 
+const PaintRef &Path::editFillColor() {
+	if (fillColorShared) {
+		if (fillColor.use_count() > 1) {
+			_setFillColor(fillColor->clone());
+		}
+		fillColorShared = false;
+	}
+	return fillColor;
+}
+
+const PaintRef &Path::editLineColor() {
+	if (lineColorShared) {
+		if (lineColor.use_count() > 1) {
+			_setLineColor(lineColor->clone());
+		}
+		lineColorShared = false;
+	}
+	return lineColor;
+}
+
 bool Path::areColorsSolid() const {
 	return nsvg.stroke.type <= NSVG_PAINT_COLOR &&
 		nsvg.fill.type <= NSVG_PAINT_COLOR;
@@ -161,7 +199,10 @@ void Path::set(const NSVGshape *shape) {
 }
 
 Path::Path() :
-	changes(CHANGED_BOUNDS | CHANGED_EXACT_BOUNDS) {
+	changes(CHANGED_BOUNDS | CHANGED_EXACT_BOUNDS),
+	fillColorShared(false),
+	lineColorShared(false),
+	version(0) {
 
 	memset(&nsvg, 0, sizeof(nsvg));
 
@@ -188,13 +229,21 @@ Path::Path() :
 }
 
 Path::Path(const NSVGshape *shape) :
-	changes(0) {
+	changes(0),
+	fillColorShared(false),
+	lineColorShared(false),
+	version(0) {
 
 	set(shape);
 	newSubpath = true;
 }
 
-Path::Path(const char *d) : changes(0) {
+Path::Path(const char *d) :
+	changes(0),
+	fillColorShared(false),
+	lineColorShared(false),
+	version(0) {
+
 	NSVGimage *image = nsvg::parsePath(d);
 	set(image->shapes);
 	nsvgDelete(image);
@@ -202,16 +251,41 @@ Path::Path(const char *d) : changes(0) {
 	newSubpath = true;
 }
 
-Path::Path(const Path *path) :
-	changes(CHANGED_BOUNDS | CHANGED_EXACT_BOUNDS) {
+static inline bool sharePaint(const PaintRef &paint, bool &shared) {
+	// only share paints that no one else (e.g. a handle) holds on to.
+	if (paint && paint.use_count() == 1) {
+		shared = true;
+	}
+	return shared;
+}
+
+Path::Path(const Path *path, bool copyOnWrite) :
+	changes(CHANGED_BOUNDS | CHANGED_EXACT_BOUNDS),
+	fillColorShared(false),
+	lineColorShared(false),
+	version(0) {
 
 	memset(&nsvg, 0, sizeof(nsvg));
 
 	strcpy(nsvg.id, path->nsvg.id);
 	name = path->name;
 
-	_setFillColor(path->fillColor ? path->fillColor->clone() : PaintRef());
-	_setLineColor(path->lineColor ? path->lineColor->clone() : PaintRef());
+	// storing a shared gradient would write to its inverse record, which
+	// a snapshot's worker might be reading right now; copy it instead.
+	if (copyOnWrite && (path->fillColorShared ||
+		sharePaint(path->fillColor, path->fillColorShared))) {
+		_setFillColor(path->fillColor, &path->nsvg.fill);
+		fillColorShared = true;
+	} else {
+		_setFillColor(path->fillColor ? path->fillColor->clone() : PaintRef());
+	}
+	if (copyOnWrite && (path->lineColorShared ||
+		sharePaint(path->lineColor, path->lineColorShared))) {
+		_setLineColor(path->lineColor, &path->nsvg.stroke);
+		lineColorShared = true;
+	} else {
+		_setLineColor(path->lineColor ? path->lineColor->clone() : PaintRef());
+	}
 
 	nsvg.opacity = path->nsvg.opacity;
 	nsvg.strokeWidth = path->nsvg.strokeWidth;
@@ -234,8 +308,8 @@ Path::Path(const Path *path) :
 	}
 
 	subpaths.reserve(path->subpaths.size());
-	for (int i = 0; i < path->subpaths.size(); i++) {
-		_append(tove_make_shared<Subpath>(path->subpaths[i]));
+	for (int i = 0; i < int(path->subpaths.size()); i++) {
+		_append(tove_make_shared<Subpath>(path->subpaths[i], copyOnWrite));
 	}
 
 	newSubpath = true;
@@ -272,7 +346,7 @@ SubpathRef Path::beginSubpath() {
 	closeSubpath();
 
 	SubpathRef trajectory = tove_make_shared<Subpath>();
-	trajectory->addObserver(this);
+	adopt(trajectory);
 	if (subpaths.empty()) {
 		nsvg.paths = &trajectory->nsvg;
 	} else {
@@ -483,7 +557,9 @@ void Path::set(const PathRef &path, const nsvg::Transform &transform) {
 		{
 			PaintRef newFillColor;
 			if (path->fillColor) {
-				newFillColor = fillColor;
+				if (!fillColorShared) {
+					newFillColor = fillColor;
+				}
 				path->fillColor->cloneTo(newFillColor, transform);
 			}
 			_setFillColor(newFillColor);
@@ -492,7 +568,9 @@ void Path::set(const PathRef &path, const nsvg::Transform &transform) {
 		{
 			PaintRef newLineColor;
 			if (path->lineColor) {
-				newLineColor = lineColor;
+				if (!lineColorShared) {
+					newLineColor = lineColor;
+				}
 				path->lineColor->cloneTo(newLineColor, transform);
 			}
 			_setLineColor(newLineColor);
@@ -678,7 +756,7 @@ void Path::animate(const PathRef &a, const PathRef &b, float t, int pathIndex) {
 		if (!fillColor) {
 			setFillColor(a->fillColor->clone());
 		}
-		if (!fillColor->animate(a->fillColor, b->fillColor, t)) {
+		if (!editFillColor()->animate(a->fillColor, b->fillColor, t)) {
 			if (tove::report::warnings()) {
 				std::ostringstream message;
 				message << "cannot animate fill color " <<
@@ -693,7 +771,7 @@ void Path::animate(const PathRef &a, const PathRef &b, float t, int pathIndex) {
 		if (!lineColor) {
 			setLineColor(a->lineColor->clone());
 		}
-		if (!lineColor->animate(a->lineColor, b->lineColor, t)) {
+		if (!editLineColor()->animate(a->lineColor, b->lineColor, t)) {
 			if (tove::report::warnings()) {
 				std::ostringstream message;
 				message << "cannot animate line color " <<
@@ -801,7 +879,10 @@ void Path::rotate(ToveElementType what, int k) {
 	}
 }
 
-bool Path::morphify(const std::vector<PathRef> &paths) {
+bool Path::morphify(
+	const std::vector<PathRef> &paths,
+	ToveMorphStrategy strategy) {
+
 	if (paths.size() < 2) {
 		return false;
 	}
@@ -821,7 +902,7 @@ bool Path::morphify(const std::vector<PathRef> &paths) {
 		for (int i = 0; i < paths.size(); i++) {
 			subpaths.push_back(paths[i]->getSubpath(j));
 		}
-		Subpath::morphify(subpaths);
+		Subpath::morphify(subpaths, strategy);
 	}
 
 	return true;
@@ -838,12 +919,52 @@ void Path::updateNSVG() {
 		if (t->getNumPoints() > 0) {
 			// NanoSVG will crash on subpaths
 			// with 0 points. exlude them now.
-			*link = &t->nsvg;
+			if (*link != &t->nsvg) {
+				*link = &t->nsvg;
+			}
 			link = &t->nsvg.next;
 		}
 	}
 
-	*link = nullptr;
+	// (only write on actual changes, as frozen paths get here
+	// from several threads.)
+	if (*link) {
+		*link = nullptr;
+	}
+}
+
+void Path::freeze() {
+	for (const auto &t : subpaths) {
+		if (!t->isFrozen()) {
+			t->freeze();
+		}
+	}
+	updateNSVG();
+	getExactBounds();
+}
+
+void Path::addMemoryUsage(ToveMemoryUsage &usage) const {
+	usage.nsvg += sizeof(nsvg);
+	footprint::add(usage.nsvg, usage, subpaths);
+#ifdef NSVG_CLIP_PATHS
+	footprint::add(usage.nsvg, usage, clipIndices);
+#endif
+	for (const auto &t : subpaths) {
+		t->addMemoryUsage(usage);
+	}
+	if (fillColor) {
+		fillColor->addMemoryUsage(usage);
+	}
+	if (lineColor) {
+		lineColor->addMemoryUsage(usage);
+	}
+}
+
+void Path::compact() {
+	for (const auto &t : subpaths) {
+		t->compact();
+	}
+	subpaths.shrink_to_fit();
 }
 
 void Path::geometryChanged() {
@@ -867,7 +988,19 @@ void Path::observableChanged(Observable *observable, ToveChangeFlags flags) {
 	changed(flags);
 }
 
+void Path::endEdit() {
+	Observable::endEdit();
+	if (!isEditing() && !editingSubpaths.empty()) {
+		std::vector<SubpathRef> adopted;
+		adopted.swap(editingSubpaths);
+		for (const auto &subpath : adopted) {
+			subpath->endEdit();
+		}
+	}
+}
+
 void Path::changed(ToveChangeFlags flags) {
+	version++;
 	if (flags & (CHANGED_GEOMETRY | CHANGED_POINTS | CHANGED_BOUNDS)) {
 		changes |= CHANGED_BOUNDS | CHANGED_EXACT_BOUNDS;
 	}
@@ -35,15 +35,28 @@ private:
 	uint8_t changes;
 	float exactBounds[4];
 
+	// set on copy-on-write clones (and their source) while a paint
+	// might still be shared with another path.
+	mutable bool fillColorShared;
+	mutable bool lineColorShared;
+
+	uint32_t version; // incremented on every change
+
+	// subpaths added during an edit; they stay in edit until we leave it.
+	std::vector<SubpathRef> editingSubpaths;
+
 	inline const SubpathRef &current() const {
 		return subpaths[subpaths.size() - 1];
 	}
 
 	void setSubpathCount(int n);
 	void _append(const SubpathRef &trajectory);
+	void adopt(const SubpathRef &trajectory);
 
-	void _setFillColor(const PaintRef &color);
-	void _setLineColor(const PaintRef &color);
+	// stored, if given, is the paint as some other path already stored
+	// it; it is copied instead of storing a (shared) paint again.
+	void _setFillColor(const PaintRef &color, const NSVGpaint *stored = nullptr);
+	void _setLineColor(const PaintRef &color, const NSVGpaint *stored = nullptr);
 
 	void set(const NSVGshape *shape);
 
@@ -55,7 +68,7 @@ public:
 	Path();
 	Path(const NSVGshape *shape);
 	Path(const char *d);
-	Path(const Path *path);
+	Path(const Path *path, bool copyOnWrite = false);
 
 	virtual ~Path() {
 		clear();
@@ -90,6 +103,8 @@ public:
 		return fillColor;
 	}
 
+	const PaintRef &editFillColor();
+
 	bool areColorsSolid() const;
 	PathPaintInd createPaintIndices(PaintIndex &it) const;
 
@@ -107,6 +122,8 @@ public:
 		return lineColor;
 	}
 
+	const PaintRef &editLineColor();
+
 	inline float getOpacity() const {
 		return nsvg.opacity;
 	}
@@ -152,7 +169,9 @@ public:
 	void animate(const PathRef &a, const PathRef &b, float t, int pathIndex);
 	void refine(int factor);
 	void rotate(ToveElementType what, int k);
-	static bool morphify(const std::vector<PathRef> &paths);
+	static bool morphify(
+		const std::vector<PathRef> &paths,
+		ToveMorphStrategy strategy = TOVE_MORPH_MINIMAL);
 
 	PathRef clone() const;
 
@@ -174,6 +193,18 @@ public:
 
 	void updateNSVG();
 
+	// see Subpath::freeze().
+	void freeze();
+
+	void addMemoryUsage(ToveMemoryUsage &usage) const;
+
+	// see Subpath::compact().
+	void compact();
+
+	inline uint32_t getVersion() const {
+		return version;
+	}
+
 	inline NSVGshape *getNSVG() {
 		updateNSVG();
 		return &nsvg;
@@ -185,6 +216,12 @@ public:
 
 	virtual void observableChanged(Observable *observable, ToveChangeFlags flags);
 
+	virtual bool isOwner() const {
+		return true;
+	}
+
+	virtual void endEdit();
+
 	inline int getSubpathSize(int i, const RigidFlattener &flattener) const {
 		return flattener.size(subpaths[i]);
 	}
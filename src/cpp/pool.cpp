@@ -0,0 +1,116 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "common.h"
+#include "pool.h"
+#include <algorithm>
+#include <cstdlib>
+
+BEGIN_TOVE_NAMESPACE
+
+static const size_t slabSize = 64 * 1024;
+
+BlockPool::BlockPool(size_t blockSize) :
+	blockSize(std::max(blockSize, sizeof(FreeBlock))),
+	blocksPerSlab(std::max(size_t(1), slabSize / blockSize)),
+	freeList(nullptr) {
+}
+
+void BlockPool::grow() {
+	// operator new aligns to at least ALIGNMENT on our platforms, and
+	// blockSize is a multiple of it.
+	uint8_t *slab = static_cast<uint8_t*>(
+		::operator new(blockSize * blocksPerSlab));
+	slabs.push_back(slab);
+
+	for (size_t i = blocksPerSlab; i > 0; i--) {
+		FreeBlock *block = reinterpret_cast<FreeBlock*>(
+			slab + (i - 1) * blockSize);
+		block->next = freeList;
+		freeList = block;
+	}
+}
+
+void *BlockPool::allocate() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!freeList) {
+		grow();
+	}
+	FreeBlock *block = freeList;
+	freeList = block->next;
+	return block;
+}
+
+void BlockPool::deallocate(void *p) {
+	std::lock_guard<std::mutex> lock(mutex);
+	FreeBlock *block = static_cast<FreeBlock*>(p);
+	block->next = freeList;
+	freeList = block;
+}
+
+namespace {
+
+// power of two point capacities from 8 (see nextpow2) to 512 points.
+enum {
+	MIN_POINTS_SHIFT = 3,
+	MAX_POINTS_SHIFT = 9
+};
+
+BlockPool &pointsPool(int shift) {
+	const size_t pointSize = 2 * sizeof(float);
+	switch (shift) {
+		case 3: return BlockPool::get<pointSize << 3>();
+		case 4: return BlockPool::get<pointSize << 4>();
+		case 5: return BlockPool::get<pointSize << 5>();
+		case 6: return BlockPool::get<pointSize << 6>();
+		case 7: return BlockPool::get<pointSize << 7>();
+		case 8: return BlockPool::get<pointSize << 8>();
+		default: return BlockPool::get<pointSize << 9>();
+	}
+}
+
+inline int pointsShift(int capacity) {
+	int shift = 0;
+	while ((1 << shift) < capacity) {
+		shift++;
+	}
+	return shift;
+}
+
+} // namespace
+
+float *allocatePoints(int capacity) {
+	const int shift = pointsShift(capacity);
+	if (shift >= MIN_POINTS_SHIFT && shift <= MAX_POINTS_SHIFT &&
+		(1 << shift) == capacity) {
+		return static_cast<float*>(pointsPool(shift).allocate());
+	}
+	float *pts = static_cast<float*>(malloc(capacity * 2 * sizeof(float)));
+	if (!pts) {
+		throw std::bad_alloc();
+	}
+	return pts;
+}
+
+void freePoints(float *pts, int capacity) {
+	if (!pts) {
+		return;
+	}
+	const int shift = pointsShift(capacity);
+	if (shift >= MIN_POINTS_SHIFT && shift <= MAX_POINTS_SHIFT &&
+		(1 << shift) == capacity) {
+		pointsPool(shift).deallocate(pts);
+	} else {
+		free(pts);
+	}
+}
+
+END_TOVE_NAMESPACE
@@ -0,0 +1,119 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_POOL
+#define __TOVE_POOL 1
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+BEGIN_TOVE_NAMESPACE
+
+// a pool of equally sized blocks. blocks are carved from larger slabs,
+// so that objects of one kind end up close to each other in memory, and
+// are recycled through a free list instead of going back to the system.
+// slabs are never released.
+
+class BlockPool {
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	const size_t blockSize;
+	const size_t blocksPerSlab;
+	FreeBlock *freeList;
+	std::vector<uint8_t*> slabs;
+	std::mutex mutex;
+
+	void grow();
+
+public:
+	enum {
+		ALIGNMENT = 16,
+		MAX_BLOCK_SIZE = 4096
+	};
+
+	BlockPool(size_t blockSize);
+
+	void *allocate();
+	void deallocate(void *p);
+
+	// pools are shared by all allocations of the same (rounded) size and
+	// live until the process ends, as objects might be released late
+	// during static destruction.
+	template<size_t Size>
+	static inline BlockPool &get() {
+		static BlockPool *pool = new BlockPool(Size);
+		return *pool;
+	}
+};
+
+// allocator for std::allocate_shared, which puts the object together with
+// its control block into a BlockPool of matching size.
+
+template<typename T>
+class PoolAllocator {
+	enum {
+		BLOCK_SIZE = (sizeof(T) + BlockPool::ALIGNMENT - 1) &
+			~size_t(BlockPool::ALIGNMENT - 1),
+		POOLED = BLOCK_SIZE <= BlockPool::MAX_BLOCK_SIZE &&
+			alignof(T) <= BlockPool::ALIGNMENT
+	};
+
+public:
+	typedef T value_type;
+
+	inline PoolAllocator() {
+	}
+
+	template<typename U>
+	inline PoolAllocator(const PoolAllocator<U> &) {
+	}
+
+	inline T *allocate(size_t n) {
+		if (POOLED && n == 1) {
+			return static_cast<T*>(BlockPool::get<BLOCK_SIZE>().allocate());
+		} else {
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+	}
+
+	inline void deallocate(T *p, size_t n) {
+		if (POOLED && n == 1) {
+			BlockPool::get<BLOCK_SIZE>().deallocate(p);
+		} else {
+			::operator delete(p);
+		}
+	}
+
+	template<typename U>
+	inline bool operator==(const PoolAllocator<U> &) const {
+		return true;
+	}
+
+	template<typename U>
+	inline bool operator!=(const PoolAllocator<U> &) const {
+		return false;
+	}
+};
+
+// point arrays of subpaths. capacity is given in points and is a power of
+// two (see nextpow2()); larger arrays are served by malloc.
+
+float *allocatePoints(int capacity);
+void freePoints(float *pts, int capacity);
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_POOL
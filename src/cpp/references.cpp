@@ -11,6 +11,7 @@
 
 #include "common.h"
 #include "references.h"
+#include "palette.h"
 #include <sstream>
 
 BEGIN_TOVE_NAMESPACE
@@ -32,5 +33,13 @@ References<AbstractMesh, ToveMeshRef> meshes;
 References<AbstractTesselator, ToveTesselatorRef> tesselators;
 References<Palette, TovePaletteRef> palettes;
 References<std::string, ToveNameRef> names;
+References<Timeline, ToveTimelineRef> timelines;
+References<GraphicsSnapshot, ToveSnapshotRef> snapshots;
+References<AbstractJob, ToveJobRef> jobs;
+
+Palette *Palette::deref(void *palette) {
+	// palette is the ptr of a TovePaletteRef handle.
+	return palettes.lookup(TovePaletteRef{palette}).get();
+}
 
 END_TOVE_NAMESPACE
@@ -9,15 +9,95 @@
  * All rights reserved.
  */
 
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
 BEGIN_TOVE_NAMESPACE
 
 #if TOVE_GODOT || TOVE_TARGET == TOVE_TARGET_LOVE2D
 
+// handles given out through the C API are not pointers, but slot indices
+// into slab-allocated tables, tagged with the slot's generation so that
+// stale handles can be told apart from new ones in a reused slot. handles
+// for the same object share a slot and are reference counted, so that
+// repeated gets neither allocate nor fill the table.
+
 template<typename T, typename ToveType>
 struct References {
 public:
 	typedef SharedPtr<T> Ref;
 
+private:
+	enum {
+		SLAB_BITS = 10,
+		SLAB_SIZE = 1 << SLAB_BITS,
+		INDEX_BITS = 22
+	};
+
+	struct Slot {
+		Ref ref;
+		uint32_t count; // outstanding handles, 0 if free
+		uint32_t generation;
+		uint32_t nextFree;
+	};
+
+	std::vector<std::unique_ptr<Slot[]>> slabs;
+	std::unordered_map<const T*, uint32_t> cached;
+	uint32_t numSlots;
+	uint32_t freeSlot; // index + 1, or 0
+	const Ref nil;
+
+	inline Slot &slot(uint32_t index) const {
+		return slabs[index >> SLAB_BITS][index & (SLAB_SIZE - 1)];
+	}
+
+	static inline uintptr_t generationMask() {
+		return (uintptr_t(1) << std::min<int>(32, sizeof(uintptr_t) * 8 - INDEX_BITS)) - 1;
+	}
+
+	inline ToveType handle(uint32_t index) const {
+		const uintptr_t generation = slot(index).generation & generationMask();
+		return ToveType{reinterpret_cast<void*>(
+			(generation << INDEX_BITS) | (index + 1))};
+	}
+
+	inline bool resolve(const ToveType &handle, uint32_t &index) const {
+		const uintptr_t h = reinterpret_cast<uintptr_t>(handle.ptr);
+		const uintptr_t i = h & ((uintptr_t(1) << INDEX_BITS) - 1);
+		if (i < 1 || i > numSlots) {
+			return false;
+		}
+		index = i - 1;
+		const Slot &s = slot(index);
+		return s.count > 0 && (h >> INDEX_BITS) == (s.generation & generationMask());
+	}
+
+	uint32_t allocate(const Ref &ref) {
+		uint32_t index;
+		if (freeSlot) {
+			index = freeSlot - 1;
+			freeSlot = slot(index).nextFree;
+		} else {
+			if (numSlots >= (1 << INDEX_BITS) - 1) {
+				TOVE_BAD_ALLOC();
+			}
+			index = numSlots++;
+			if ((index >> SLAB_BITS) >= slabs.size()) {
+				slabs.emplace_back(new Slot[SLAB_SIZE]);
+			}
+			slot(index).generation = 0;
+		}
+		Slot &s = slot(index);
+		s.ref = ref;
+		s.count = 1;
+		return index;
+	}
+
+public:
+	inline References() : numSlots(0), freeSlot(0) {
+	}
+
 	template<typename... Params>
 	inline ToveType make(Params... params) {
 		return publish(tove_make_shared<T>(params...));
@@ -25,85 +105,129 @@ public:
 
 	inline ToveType publish(const Ref &ref) {
 		assert(ref.get() != nullptr);
-		Ref *newRef = new Ref(ref);
-		return ToveType{newRef};
+		const auto found = cached.find(ref.get());
+		if (found != cached.end()) {
+			slot(found->second).count++;
+			return handle(found->second);
+		}
+		const uint32_t index = allocate(ref);
+		cached[ref.get()] = index;
+		return handle(index);
 	}
 
 	inline ToveType publishEmpty() {
-		Ref *newRef = new Ref();
-		return ToveType{newRef};
+		return handle(allocate(Ref()));
 	}
 
 	inline ToveType publishOrNil(const Ref &ref) {
 		if (ref.get() == nullptr) {
 			return ToveType{nullptr};
 		} else {
-			Ref *newRef = new Ref(ref);
-			return ToveType{newRef};
+			return publish(ref);
 		}
 	}
 
-	inline void release(const ToveType &ref) {
-		delete static_cast<const Ref*>(ref.ptr);
+	inline const Ref &lookup(const ToveType &handle) const {
+		uint32_t index;
+		if (resolve(handle, index)) {
+			return slot(index).ref;
+		} else {
+			return nil;
+		}
+	}
+
+	inline void release(const ToveType &handle) {
+		uint32_t index;
+		if (!resolve(handle, index)) {
+			return;
+		}
+		Slot &s = slot(index);
+		if (--s.count > 0) {
+			return;
+		}
+		if (s.ref.get()) {
+			cached.erase(s.ref.get());
+		}
+		s.ref.reset();
+		s.generation++;
+		s.nextFree = freeSlot;
+		freeSlot = index + 1;
 	}
 };
 
+extern References<Graphics, ToveGraphicsRef> shapes;
+extern References<Path, TovePathRef> paths;
+extern References<Subpath, ToveSubpathRef> trajectories;
+extern References<AbstractPaint, TovePaintRef> paints;
+extern References<AbstractFeed, ToveFeedRef> shaderLinks;
+extern References<AbstractMesh, ToveMeshRef> meshes;
+extern References<AbstractTesselator, ToveTesselatorRef> tesselators;
+extern References<Palette, TovePaletteRef> palettes;
+extern References<std::string, ToveNameRef> names;
+extern References<Timeline, ToveTimelineRef> timelines;
+extern References<GraphicsSnapshot, ToveSnapshotRef> snapshots;
+extern References<AbstractJob, ToveJobRef> jobs;
+
+
 void encounteredNilRef(const char *typeName);
 
-template<typename T, typename R>
-inline const T &_deref(const R &ref) {
-	const T &p = *static_cast<const T*>(ref.ptr);
+template<typename T, typename ToveType>
+inline const SharedPtr<T> &_deref(
+	const References<T, ToveType> &references, const ToveType &ref) {
+	const SharedPtr<T> &p = references.lookup(ref);
 	if (!p.get()) {
-		encounteredNilRef(typeid(T).name());
+		encounteredNilRef(typeid(SharedPtr<T>).name());
 	}
 	return p;
 }
 
 inline const GraphicsRef &deref(const ToveGraphicsRef &ref) {
-	return _deref<GraphicsRef>(ref);
+	return _deref(shapes, ref);
 }
 
 inline const PathRef &deref(const TovePathRef &ref) {
-	return _deref<PathRef>(ref);
+	return _deref(paths, ref);
 }
 
 inline const SubpathRef &deref(const ToveSubpathRef &ref) {
-	return _deref<SubpathRef>(ref);
+	return _deref(trajectories, ref);
 }
 
 inline const PaintRef &deref(const TovePaintRef &ref) {
-	return *static_cast<const PaintRef*>(ref.ptr);
+	return paints.lookup(ref);
 }
 
 inline const FeedRef &deref(const ToveFeedRef &ref) {
-	return _deref<FeedRef>(ref);
+	return _deref(shaderLinks, ref);
 }
 
 inline const MeshRef &deref(const ToveMeshRef &ref) {
-	return _deref<MeshRef>(ref);
+	return _deref(meshes, ref);
 }
 
 inline const TesselatorRef &deref(const ToveTesselatorRef &ref) {
-	return _deref<TesselatorRef>(ref);
+	return _deref(tesselators, ref);
 }
 
 inline const PaletteRef &deref(const TovePaletteRef &ref) {
-	return _deref<PaletteRef>(ref);
+	return _deref(palettes, ref);
 }
 
 inline const NameRef &deref(const ToveNameRef &ref) {
-	return _deref<NameRef>(ref);
+	return _deref(names, ref);
 }
 
-extern References<Graphics, ToveGraphicsRef> shapes;
-extern References<Path, TovePathRef> paths;
-extern References<Subpath, ToveSubpathRef> trajectories;
-extern References<AbstractPaint, TovePaintRef> paints;
-extern References<AbstractFeed, ToveFeedRef> shaderLinks;
-extern References<AbstractMesh, ToveMeshRef> meshes;
-extern References<AbstractTesselator, ToveTesselatorRef> tesselators;
-extern References<Palette, TovePaletteRef> palettes;
-extern References<std::string, ToveNameRef> names;
+inline const TimelineRef &deref(const ToveTimelineRef &ref) {
+	return _deref(timelines, ref);
+}
+
+inline const SnapshotRef &deref(const ToveSnapshotRef &ref) {
+	return _deref(snapshots, ref);
+}
+
+inline const JobRef &deref(const ToveJobRef &ref) {
+	return _deref(jobs, ref);
+}
 
 #endif // TOVE_TARGET_LOVE2D
 
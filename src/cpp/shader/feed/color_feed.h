@@ -13,9 +13,24 @@
 #define __TOVE_SHADER_LINK 1
 
 #include "paint_feed.h"
+#include "../../footprint.h"
 
 BEGIN_TOVE_NAMESPACE
 
+// color ramps and matrices of numMatrices gradients, as bound by the caller.
+inline void addGradientMemoryUsage(
+	const ToveGradientData &data,
+	int numMatrices,
+	ToveMemoryUsage &usage) {
+
+	if (data.colorsTexture) {
+		usage.geometry += data.colorsTextureRowBytes * data.colorsTextureHeight;
+	}
+	if (data.matrix) {
+		usage.geometry += numMatrices * 3 * data.matrixRows * sizeof(float);
+	}
+}
+
 class AbstractFeed {
 public:
 	virtual ~AbstractFeed() {
@@ -28,6 +43,10 @@ public:
     	return nullptr;
     }
 
+	virtual ToveGPUXAtlasData *getAtlasData() {
+		return nullptr;
+	}
+
 	virtual TovePaintColorAllocation getColorAllocation() const {
 		return TovePaintColorAllocation{0, 0, 0};
 	}
@@ -37,6 +56,9 @@ public:
 
 	virtual void bind(const ToveGradientData &data) {
 	}
+
+	virtual void addMemoryUsage(ToveMemoryUsage &usage) const {
+	}
 };
 
 class ColorFeed : public AbstractFeed {
@@ -45,6 +67,7 @@ private:
 	const float scale;
 	PaintIndicesRef paints;
 	std::vector<PaintFeed> feeds;
+	ToveGradientData bound;
 
 public:
 	ColorFeed(const GraphicsRef &graphics, float scale) :
@@ -52,6 +75,8 @@ public:
 		scale(scale),
 		paints(graphics->getPaintIndices()) {
 
+		std::memset(&bound, 0, sizeof(bound));
+
 		const int n = graphics->getNumPaths();
 		for (int i = 0; i < n; i++) {
 			const PathRef &path = graphics->getPath(i);
@@ -81,6 +106,8 @@ public:
 	}
 
 	void bindPaintIndices(const ToveGradientData &data) {
+		bound = data;
+
 		const int n = feeds.size();
 		for (int i = 0; i < n; i++) {
 			feeds[i].bindPaintIndices(data);
@@ -122,7 +149,14 @@ public:
 
 	float getScale() const { return scale; }
 
+	virtual void addMemoryUsage(ToveMemoryUsage &usage) const {
+		footprint::add(usage.geometry, usage, feeds);
+		// matrix 0 is reserved for solid colors.
+		addGradientMemoryUsage(bound, bound.numGradients + 1, usage);
+	}
+
 	virtual ToveChangeFlags beginUpdate() {
+		TOVE_TRACE_ZONE("feed.paint");
 		ToveChangeFlags changes = 0;
 		for (auto &feed : feeds) {
 			changes |= feed.beginUpdate();
@@ -131,6 +165,7 @@ public:
 	}
 
     virtual ToveChangeFlags endUpdate() {
+		TOVE_TRACE_ZONE("feed.paint");
 		ToveChangeFlags changes = 0;
 		for (auto &feed : feeds) {
 			changes |= feed.endUpdate();
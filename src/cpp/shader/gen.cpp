@@ -322,7 +322,9 @@ vec4 do_vertex(vec4 vertex_pos) {
 
 	w.beginFragmentShader();
 
-	if (!meshBand) {
+	if (!meshBand && data->geometry.gridSize > 0) {
+		w << "#define GRID_CELLS 1\n";
+	} else if (!meshBand) {
 		// encourage shader caching by trying to reduce code changing states.
 		const int lutN = tove::nextpow2(data->geometry.lookupTableSize);
 
@@ -342,6 +344,10 @@ vec4 do_vertex(vec4 vertex_pos) {
 		w << "#define GPUX_DEBUG 1\n";
 	}
 
+	if (data->geometry.listsIndexSize > 1) {
+		w << "#define LISTS_16BIT 1\n";
+	}
+
 	w << "#define FILL_RULE "<< data->geometry.fillRule << "\n";
 	w << "#define CURVE_DATA_SIZE "<<
 		data->geometry.curvesTextureSize[0] << "\n";
@@ -363,6 +369,83 @@ vec4 do_vertex(vec4 vertex_pos) {
 	return code;
 }
 
+const char *GetGPUXAtlasShaderCode(
+	const ToveGPUXAtlasData *data, int numPaints, int numGradients) {
+
+	tove::ShaderWriter w;
+
+	w.define("NUM_PAINTS", numPaints);
+	w.define("NUM_GRADIENTS", numGradients);
+
+	w << R"GLSL(
+varying vec4 raw_vertex_pos;
+varying vec2 gradient_pos;
+flat varying vec3 gradient_scale;
+varying vec2 texture_pos;
+)GLSL";
+
+	w.beginVertexShader();
+
+	w << R"GLSL(
+attribute vec4 VertexPaint;
+
+uniform MATRIX matrix[NUM_GRADIENTS + 1];
+uniform float cstep;
+
+vec4 do_vertex(vec4 vertex_pos) {
+	// vertex_pos.z is the path index into the header texture.
+	raw_vertex_pos = vertex_pos;
+
+	ivec4 IntVertexPaint = ivec4(VertexPaint * 255.0f + vec4(0.4));
+
+	int i = IntVertexPaint.x + 256 * IntVertexPaint.y;
+	int g = IntVertexPaint.z;
+	int t = IntVertexPaint.w;
+
+	gradient_pos = (matrix[g] * vec3(vertex_pos.xy, 1)).xy;
+	gradient_scale = vec3(cstep, 1.0f - 2.0f * cstep, t == 3 ? 1 : 0);
+
+	texture_pos = vec2((i + 0.5) / NUM_PAINTS, 0.5);
+	return vec4(vertex_pos.xy, 0, 1);
+}
+)GLSL";
+
+	w.endVertexShader();
+
+	w.beginFragmentShader();
+
+	w << "#define GRID_CELLS 1\n";
+	w << "#define GPUX_ATLAS 1\n";
+	w << "#define PAINT_ORDER 1\n";
+	w << "#define FILL_RULE 0\n";
+
+	if (data->listsIndexSize > 1) {
+		w << "#define LISTS_16BIT 1\n";
+	}
+
+	w << "#define CURVE_DATA_SIZE "<<
+		data->curvesTextureSize[0] << "\n";
+
+	w << "#define LINE_STYLE 0\n";
+	w << "#define FILL_STYLE " << PAINT_SOLID << "\n";
+
+	w << R"GLSL(
+uniform sampler2D colors;
+
+vec4 computeFillColor(vec2 _1) {
+	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
+	y = gradient_scale.x + gradient_scale.y * y;
+	return TEXEL(colors, vec2(texture_pos.x, y));
+}
+)GLSL";
+
+	#include "../../glsl/fill.frag.inc"
+
+	w.endFragmentShader();
+
+	return w.getSourcePtr();
+}
+
 ToveShaderCode GetGPUXLineShaderCode(const ToveShaderData *data) {
 	tove::ShaderWriter w;
 	ToveShaderCode code;
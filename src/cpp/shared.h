@@ -9,6 +9,8 @@
  * All rights reserved.
  */
 
+#include "pool.h"
+
 BEGIN_TOVE_NAMESPACE
 
 struct Referencable {
@@ -17,9 +19,10 @@ struct Referencable {
 template<typename T>
 using SharedPtr = std::shared_ptr<T>; 
 
+// objects and their control blocks come from BlockPools, see pool.h.
 template<typename T, typename... Args>
 SharedPtr<T> tove_make_shared(Args&&... args) {
-	return std::make_shared<T>(args...);
+	return std::allocate_shared<T>(PoolAllocator<T>(), args...);
 }
 
 END_TOVE_NAMESPACE
@@ -0,0 +1,103 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "snapshot.h"
+#include "mesh/mesh.h"
+#include "mesh/meshifier.h"
+
+BEGIN_TOVE_NAMESPACE
+
+SnapshotRef GraphicsSnapshot::capture(const GraphicsRef &graphics) {
+	graphics->closePath();
+
+	SnapshotRef previous = graphics->snapshot.lock();
+
+	if (previous && previous->version == graphics->getVersion()) {
+		return previous;
+	}
+
+	const int n = graphics->getNumPaths();
+	const int numPrevious = previous ? previous->sources.size() : 0;
+
+	SnapshotRef snapshot = tove_make_shared<GraphicsSnapshot>();
+	snapshot->version = graphics->getVersion();
+	snapshot->sources.reserve(n);
+
+	std::vector<PathRef> paths;
+	paths.reserve(n);
+
+	for (int i = 0; i < n; i++) {
+		const PathRef &path = graphics->getPath(i);
+		const Path *origin = path.get();
+
+		if (i < numPrevious) {
+			const Source &source = previous->sources[i];
+			if (source.path.lock() == path && source.version == path->getVersion()) {
+				// the frozen clone has the same data, including the
+				// curve data we would otherwise recompute.
+				origin = previous->graphics->getPath(i).get();
+			}
+		}
+
+		paths.push_back(tove_make_shared<Path>(origin, true));
+		snapshot->sources.push_back(Source{path, path->getVersion()});
+	}
+
+	const GraphicsRef frozen = tove_make_shared<Graphics>(graphics.get(), paths);
+	// work done on the snapshot counts towards the original.
+	frozen->counters = graphics->counters;
+
+#ifdef NSVG_CLIP_PATHS
+	// clip sets are immutable, so the last snapshot's clones still fit
+	// as long as the original's clip set is the same.
+	const ClipSetRef &clipSet = graphics->clipSet;
+	if (clipSet) {
+		if (previous && previous->clipSource.lock() == clipSet) {
+			frozen->clipSet = previous->graphics->clipSet;
+		} else {
+			frozen->clipSet = tove_make_shared<ClipSet>(*clipSet.get());
+		}
+		frozen->nsvg.clip.instances = frozen->clipSet->getHead();
+	}
+	snapshot->clipSource = clipSet;
+#endif
+	for (const PathRef &path : paths) {
+		path->freeze();
+	}
+	frozen->getImage();
+	frozen->getBounds();
+	frozen->getExactBounds();
+	frozen->getPaintIndices();
+	snapshot->graphics = frozen;
+
+	graphics->snapshot = snapshot;
+	return snapshot;
+}
+
+void GraphicsSnapshot::rasterize(
+	uint8_t *pixels,
+	int width, int height, int stride,
+	float tx, float ty, float scale,
+	const ToveRasterizeSettings *settings) const {
+
+	graphics->rasterize(pixels, width, height, stride,
+		tx, ty, scale, settings);
+}
+
+ToveMeshUpdateFlags GraphicsSnapshot::tesselate(
+	const TesselatorRef &tesselator,
+	const MeshRef &mesh,
+	ToveMeshUpdateFlags flags) const {
+
+	return tesselator->graphicsToMesh(graphics.get(), flags, mesh, mesh);
+}
+
+END_TOVE_NAMESPACE
@@ -0,0 +1,70 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_SNAPSHOT
+#define __TOVE_SNAPSHOT 1
+
+#include "graphics.h"
+
+BEGIN_TOVE_NAMESPACE
+
+// an immutable view of a Graphics at one point in time. its paths and
+// clip paths are copy-on-write clones, so the original can go on being
+// edited, and are frozen, so that several threads can rasterize or
+// tesselate the snapshot at once (each with its own tesselator).
+// successive snapshots of one Graphics reuse each other: if nothing
+// changed, the last snapshot is returned; otherwise unchanged paths
+// are cloned from the last snapshot with all their derived data.
+
+class GraphicsSnapshot : public Referencable {
+private:
+	struct Source {
+		std::weak_ptr<Path> path;
+		uint32_t version;
+	};
+
+	GraphicsRef graphics;
+	uint32_t version;
+	std::vector<Source> sources;
+#ifdef NSVG_CLIP_PATHS
+	std::weak_ptr<ClipSet> clipSource;
+#endif
+
+public:
+	// may only be called from the thread that edits graphics.
+	static SnapshotRef capture(const GraphicsRef &graphics);
+
+	// the snapshot's contents; callers must not modify it.
+	inline const GraphicsRef &getGraphics() const {
+		return graphics;
+	}
+
+	inline uint32_t getVersion() const {
+		return version;
+	}
+
+	void rasterize(
+		uint8_t *pixels,
+		int width, int height, int stride,
+		float tx, float ty, float scale,
+		const ToveRasterizeSettings *settings = nullptr) const;
+
+	// tesselators keep state, so each one may only serve one
+	// thread at a time.
+	ToveMeshUpdateFlags tesselate(
+		const TesselatorRef &tesselator,
+		const MeshRef &mesh,
+		ToveMeshUpdateFlags flags) const;
+};
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_SNAPSHOT
@@ -0,0 +1,51 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "stats.h"
+
+BEGIN_TOVE_NAMESPACE
+
+namespace stats {
+
+Counters global;
+
+thread_local Counters *attributed = nullptr;
+thread_local int cascading = 0;
+
+Counters::Counters() {
+	reset();
+}
+
+void Counters::reset() {
+	for (int i = 0; i < NUM_COUNTERS; i++) {
+		values[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void Counters::get(ToveStats *stats) const {
+	const auto value = [this] (Counter counter) {
+		return double(values[counter].load(std::memory_order_relaxed));
+	};
+
+	stats->curvesFlattened = value(CURVES_FLATTENED);
+	stats->verticesEmitted = value(VERTICES_EMITTED);
+	stats->triangulationsCached = value(TRIANGULATIONS_CACHED);
+	stats->triangulationsComputed = value(TRIANGULATIONS_COMPUTED);
+	stats->clipperOperations = value(CLIPPER_OPERATIONS);
+	stats->lutRebuilds = value(LUT_REBUILDS);
+	stats->pixelsRasterized = value(PIXELS_RASTERIZED);
+	stats->observerBroadcasts = value(OBSERVER_BROADCASTS);
+	stats->bytesUploaded = value(BYTES_UPLOADED);
+}
+
+} // namespace stats
+
+END_TOVE_NAMESPACE
@@ -0,0 +1,97 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_STATS
+#define __TOVE_STATS 1
+
+#include "common.h"
+#include <atomic>
+#include <cstdint>
+
+BEGIN_TOVE_NAMESPACE
+
+// always-on counters for perf overlays. call sites count in batches
+// (per subpath, per path, per call), never per point, so that a relaxed
+// atomic add stays cheap. counts also go to the Graphics currently being
+// worked on by this thread, if an Attribution is in scope.
+
+namespace stats {
+	enum Counter {
+		CURVES_FLATTENED,
+		VERTICES_EMITTED,
+		TRIANGULATIONS_CACHED,
+		TRIANGULATIONS_COMPUTED,
+		CLIPPER_OPERATIONS,
+		LUT_REBUILDS,
+		PIXELS_RASTERIZED,
+		OBSERVER_BROADCASTS,
+		BYTES_UPLOADED,
+		NUM_COUNTERS
+	};
+
+	class Counters {
+		std::atomic<uint64_t> values[NUM_COUNTERS];
+
+	public:
+		Counters();
+
+		inline void add(Counter counter, uint64_t n) {
+			values[counter].fetch_add(n, std::memory_order_relaxed);
+		}
+
+		void reset();
+		void get(ToveStats *stats) const;
+	};
+
+	extern Counters global;
+	extern thread_local Counters *attributed;
+	extern thread_local int cascading;
+
+	inline void count(Counter counter, uint64_t n = 1) {
+		global.add(counter, n);
+		if (attributed) {
+			attributed->add(counter, n);
+		}
+	}
+
+	// counts once for any number of nested cascades on this thread, so
+	// that e.g. a subpath's change, passed on by its path and graphics,
+	// counts as one broadcast.
+	class Cascade {
+	public:
+		inline Cascade(Counter counter) {
+			if (cascading++ == 0) {
+				count(counter);
+			}
+		}
+
+		inline ~Cascade() {
+			cascading--;
+		}
+	};
+
+	class Attribution {
+		Counters * const previous;
+
+	public:
+		inline Attribution(Counters *counters) : previous(attributed) {
+			attributed = counters;
+		}
+
+		inline ~Attribution() {
+			attributed = previous;
+		}
+	};
+} // namespace stats
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_STATS
@@ -25,11 +25,16 @@ float *Subpath::addPoints(int n, bool allowClosedEdit) {
 	if (!allowClosedEdit && isClosed()) {
 		tove::report::warn("editing closed trajectory.");
 	}
+	ownPoints();
 	const int cpts = nextpow2(nsvg.npts + n);
-	nsvg.pts = static_cast<float*>(
-		realloc(nsvg.pts, cpts * 2 * sizeof(float)));
-	if (!nsvg.pts) {
-		throw std::bad_alloc();
+	if (cpts != capacity) {
+		float *pts = allocatePoints(cpts);
+		if (nsvg.pts) {
+			std::memcpy(pts, nsvg.pts, nsvg.npts * 2 * sizeof(float));
+			freePoints(nsvg.pts, capacity);
+		}
+		nsvg.pts = pts;
+		capacity = cpts;
 	}
 	float *p = &nsvg.pts[nsvg.npts * 2];
 	nsvg.npts += n;
@@ -93,42 +98,89 @@ Subpath::Subpath() {
 		nsvg.bounds[i] = 0.0;
 	}
 	dirty = DIRTY_BOUNDS;
+	capacity = 0;
+	levelsDepth = -1;
+	levelsTolerance = 0.0f;
+	frozen = false;
 }
 
 Subpath::Subpath(const NSVGpath *path) {
 	memset(&nsvg, 0, sizeof(nsvg));
 	nsvg.closed = path->closed;
 	nsvg.npts = path->npts;
-	const size_t size = path->npts * 2 * sizeof(float);
-	nsvg.pts = static_cast<float*>(malloc(size));
-	if (!nsvg.pts) {
-		throw std::bad_alloc();
-	}
-	std::memcpy(nsvg.pts, path->pts, size);
+	capacity = nextpow2(path->npts);
+	nsvg.pts = allocatePoints(capacity);
+	std::memcpy(nsvg.pts, path->pts, path->npts * 2 * sizeof(float));
 	for (int i = 0; i < 4; i++) {
 		nsvg.bounds[i] = path->bounds[i];
 	}
 	dirty = DIRTY_COEFFICIENTS | DIRTY_CURVE_BOUNDS;
+	levelsDepth = -1;
+	levelsTolerance = 0.0f;
+	frozen = false;
 }
 
-Subpath::Subpath(const SubpathRef &t) {
+Subpath::Subpath(const SubpathRef &t, bool copyOnWrite) {
 	memset(&nsvg, 0, sizeof(nsvg));
 	nsvg.closed = t->nsvg.closed;
 	nsvg.npts = t->nsvg.npts;
-	const size_t size = nsvg.npts * 2 * sizeof(float);
-	nsvg.pts = static_cast<float*>(malloc(size));
-	if (!nsvg.pts) {
-		throw std::bad_alloc();
+	if (copyOnWrite) {
+		t->commit();
+		if (!t->sharedPoints && t->nsvg.pts) {
+			t->sharedPoints = tove_make_shared<SharedPoints>();
+			t->sharedPoints->pts = t->nsvg.pts;
+			t->sharedPoints->capacity = t->capacity;
+		}
+		sharedPoints = t->sharedPoints;
+		capacity = t->capacity;
+		nsvg.pts = t->nsvg.pts;
+	} else {
+		capacity = nextpow2(nsvg.npts);
+		nsvg.pts = allocatePoints(capacity);
+		std::memcpy(nsvg.pts, t->nsvg.pts, nsvg.npts * 2 * sizeof(float));
 	}
-	std::memcpy(nsvg.pts, t->nsvg.pts, size);
 	for (int i = 0; i < 4; i++) {
 		nsvg.bounds[i] = t->nsvg.bounds[i];
 	}
 	commands = t->commands;
-	dirty = t->dirty | DIRTY_COEFFICIENTS | DIRTY_CURVE_BOUNDS;
+	if (copyOnWrite) {
+		// the points are the same, so are the curves.
+		curves = t->curves;
+		dirty = t->dirty;
+	} else {
+		dirty = t->dirty | DIRTY_COEFFICIENTS | DIRTY_CURVE_BOUNDS;
+	}
+	levels = t->levels;
+	levelsDepth = t->levelsDepth;
+	levelsTolerance = t->levelsTolerance;
+	if (copyOnWrite && levelsDepth < 0 && sharedPoints) {
+		// levels that clones computed for these points (and which
+		// t does not have itself), see getSubdivisionLevels().
+		std::lock_guard<std::mutex> lock(sharedPoints->levelsMutex);
+		if (!sharedPoints->levels.empty()) {
+			const SharedPoints::Levels &cached = sharedPoints->levels.front();
+			levels = cached.values;
+			levelsDepth = cached.depth;
+			levelsTolerance = cached.tolerance;
+		}
+	}
+	frozen = false;
+}
+
+void Subpath::unsharePoints() {
+	if (sharedPoints.use_count() > 1) {
+		float *pts = allocatePoints(capacity);
+		std::memcpy(pts, nsvg.pts, nsvg.npts * 2 * sizeof(float));
+		nsvg.pts = pts;
+	} else {
+		// we are the last user, so take the points back.
+		sharedPoints->pts = nullptr;
+	}
+	sharedPoints.reset();
 }
 
 int Subpath::moveTo(float x, float y) {
+	ownPoints();
 	NSVGpath *p = &nsvg;
 	// const int index = nsvg.npts;
 	if (p->npts > 0) {
@@ -240,6 +292,7 @@ int Subpath::insertCurveAt(float globalt) {
 
 	const int i = std::min(std::max(curve * 3, 0), npts0 - 4);
 
+	ownPoints();
 	addPoints(3, true);
 	float *pts = nsvg.pts;
 
@@ -293,6 +346,7 @@ void Subpath::removeCurve(int curve) {
 	curve = umod(curve, nc);
 
 	const int i = std::max(curve * 3, 0);
+	ownPoints();
 	float *pts = nsvg.pts;
 
 	if (isLineAt(i + 3, 0)) {
@@ -358,6 +412,7 @@ void Subpath::remove(int from, int n) {
 		clipAtStart = n - clipAtEnd;
 	}
 
+	ownPoints();
 	float *pts = nsvg.pts;
 
 	std::memmove(
@@ -399,6 +454,7 @@ int Subpath::mould(float globalt, float x, float y) {
 	const float v = 1.0f - u;
 	const float ratio = std::abs((t3 + s3 - 1.0f) / (t3 + s3));
 
+	ownPoints();
 	float * const pts = nsvg.pts;
 
 	const int i = curve * 3;
@@ -489,6 +545,7 @@ void Subpath::makeFlat(int k, int dir) {
 		return;
 	}
 
+	ownPoints();
 	commit();
 	float *pts = nsvg.pts;
 
@@ -545,6 +602,7 @@ void Subpath::makeSmooth(int k, int dir, float a) {
 		return;
 	}
 
+	ownPoints();
 	commit();
 	float *pts = nsvg.pts;
 
@@ -729,7 +787,6 @@ ToveCurvature *Subpath::saveCurvature() {
 }
 
 bool Subpath::restoreCurvature() {
-	float * const pts = nsvg.pts;
 	const bool closed = isClosed();
 
 	const int npts = nsvg.npts;
@@ -739,6 +796,9 @@ bool Subpath::restoreCurvature() {
 		return false;
 	}
 
+	ownPoints();
+	float * const pts = nsvg.pts;
+
 	int k0 = closed ? (find_unequal_backward(Points(pts), nc, nc) * 3) : 0;
 	int k2 = find_unequal_forward(Points(pts), 0, nc) * 3;
 
@@ -801,6 +861,7 @@ void Subpath::move(int k, float x, float y, ToveHandle handle) {
 		return;
 	}
 
+	ownPoints();
 	commit();
 	float *pts = nsvg.pts;
 
@@ -873,6 +934,7 @@ void Subpath::move(int k, float x, float y, ToveHandle handle) {
 }
 
 void Subpath::rotate(ToveElementType what, int k) {
+	ownPoints();
 	float *pts = nsvg.pts;
 	const int n = nsvg.npts;
 	switch (what) {
@@ -894,6 +956,7 @@ void Subpath::refine(const int factor) {
 	if (factor < 2) {
 		return;
 	}
+	ownPoints();
 	const int n = getNumCurves(false);
 	for (int j = n - 1; j >= 0; j--) {
 		for (int i = factor; i > 1; i--) {
@@ -927,7 +990,173 @@ int lcm(const std::vector<int> &n) {
 	return x;
 }
 
-bool Subpath::morphify(const std::vector<SubpathRef> &subpaths) {
+static void computeArcLengths(
+	const float *pts, int numCurves, int samples, std::vector<float> &lengths) {
+
+	// cumulative arc lengths at evenly spaced t of all curves; entry
+	// c * samples + s corresponds to global t = c + s / samples.
+
+	lengths.resize(numCurves * samples + 1);
+	lengths[0] = 0.0f;
+
+	float total = 0.0f;
+	for (int c = 0; c < numCurves; c++) {
+		const float *p = pts + 6 * c;
+		float x0 = p[0];
+		float y0 = p[1];
+
+		for (int k = 1; k <= samples; k++) {
+			const float t = k / float(samples);
+			const float s = 1.0f - t;
+
+			const float w0 = s * s * s;
+			const float w1 = 3.0f * s * s * t;
+			const float w2 = 3.0f * s * t * t;
+			const float w3 = t * t * t;
+
+			const float x = w0 * p[0] + w1 * p[2] + w2 * p[4] + w3 * p[6];
+			const float y = w0 * p[1] + w1 * p[3] + w2 * p[5] + w3 * p[7];
+
+			total += length(x - x0, y - y0);
+			lengths[c * samples + k] = total;
+
+			x0 = x;
+			y0 = y;
+		}
+	}
+
+	if (total <= 0.0f) {
+		// degenerate subpath; fall back to parametric lengths.
+		for (int i = 0; i < int(lengths.size()); i++) {
+			lengths[i] = i;
+		}
+	}
+}
+
+static float arcLengthToGlobalT(
+	const std::vector<float> &lengths, int samples, float s) {
+
+	const auto i = std::upper_bound(lengths.begin(), lengths.end(), s);
+	const int k = std::max(0, std::min(
+		int(std::distance(lengths.begin(), i)) - 1, int(lengths.size()) - 2));
+
+	const float l0 = lengths[k];
+	const float l1 = lengths[k + 1];
+	const float f = l1 > l0 ? clamp((s - l0) / (l1 - l0), 0.0f, 1.0f) : 0.0f;
+
+	return (k + f) / samples;
+}
+
+void Subpath::refineTo(const std::vector<float> &reference) {
+	// inserts curves such that this subpath gets reference.size() + 1
+	// curves. the new curve boundaries are placed by matching our own
+	// curve boundaries (as arc length fractions) to the reference
+	// boundaries, and by placing unmatched reference boundaries
+	// proportionally between matched ones.
+
+	const int ownCurves = getNumCurves(false);
+	const int m = ownCurves - 1;
+	const int M = reference.size();
+
+	if (ownCurves < 1 || m >= M) {
+		return;
+	}
+
+	const int samples = 16;
+	std::vector<float> lengths;
+	computeArcLengths(nsvg.pts, ownCurves, samples, lengths);
+	const float total = lengths.back();
+
+	std::vector<float> own(m);
+	for (int i = 0; i < m; i++) {
+		own[i] = lengths[(i + 1) * samples] / total;
+	}
+
+	// monotone matching of m own boundaries to M reference boundaries
+	// that minimizes the sum of absolute differences.
+
+	const float inf = std::numeric_limits<float>::infinity();
+	const int W = M + 1;
+	std::vector<float> cost((m + 1) * W, inf);
+	for (int k = 0; k <= M; k++) {
+		cost[k] = 0.0f;
+	}
+	for (int j = 1; j <= m; j++) {
+		for (int k = j; k <= M; k++) {
+			const float skip = cost[j * W + k - 1];
+			const float match = cost[(j - 1) * W + k - 1] +
+				std::abs(own[j - 1] - reference[k - 1]);
+			cost[j * W + k] = std::min(skip, match);
+		}
+	}
+
+	// backtrack to find which reference boundary each own one maps to.
+	std::vector<int> matched(M, -1);
+	for (int j = m, k = M; j > 0; k--) {
+		if (cost[j * W + k] == cost[j * W + k - 1] && k - 1 >= j) {
+			continue;
+		}
+		matched[k - 1] = j - 1;
+		j--;
+	}
+
+	std::vector<float> insertions;
+	insertions.reserve(M - m);
+
+	float r0 = 0.0f, o0 = 0.0f;
+	int k = 0;
+	while (k < M) {
+		if (matched[k] >= 0) {
+			r0 = reference[k];
+			o0 = own[matched[k]];
+			k++;
+			continue;
+		}
+
+		int next = k;
+		while (next < M && matched[next] < 0) {
+			next++;
+		}
+		const float r1 = next < M ? reference[next] : 1.0f;
+		const float o1 = next < M ? own[matched[next]] : 1.0f;
+
+		for (; k < next; k++) {
+			const float f = r1 > r0 ? (reference[k] - r0) / (r1 - r0) : 0.5f;
+			insertions.push_back(arcLengthToGlobalT(
+				lengths, samples, (o0 + f * (o1 - o0)) * total));
+		}
+	}
+
+	// insert from back to front, so that earlier global t stay valid.
+	// splitting a curve at t1 leaves its first part parametrized in
+	// [0, t1], which we need to account for on further splits.
+
+	ownPoints();
+	std::sort(insertions.begin(), insertions.end());
+
+	int lastCurve = -1;
+	float lastT = 1.0f;
+	for (int i = insertions.size() - 1; i >= 0; i--) {
+		const float globalt = insertions[i];
+		const int curve = std::min(int(globalt), ownCurves - 1);
+		float t = globalt - curve;
+
+		if (curve == lastCurve) {
+			t = lastT > 0.0f ? t / lastT : 0.0f;
+			lastT = globalt - curve;
+		} else {
+			lastCurve = curve;
+			lastT = t;
+		}
+
+		insertCurveAt(curve + clamp(t, 0.0f, 0.999999f));
+	}
+}
+
+bool Subpath::morphify(
+	const std::vector<SubpathRef> &subpaths,
+	ToveMorphStrategy strategy) {
+
 	std::vector<int> n;
 	n.reserve(subpaths.size());
 	for (const auto &subpath : subpaths) {
@@ -937,14 +1166,42 @@ bool Subpath::morphify(const std::vector<SubpathRef> &subpaths) {
 		}
 		n.push_back(m);
 	}
-	const int common = lcm(n);
-	for (int i = 0; i < n.size(); i++) {
-		subpaths[i]->refine(common / n[i]);
+
+	if (strategy == TOVE_MORPH_LCM) {
+		const int common = lcm(n);
+		for (int i = 0; i < int(n.size()); i++) {
+			subpaths[i]->refine(common / n[i]);
+		}
+		return true;
 	}
+
+	// minimal strategy: bring all subpaths to the largest curve count
+	// by aligning their curve boundaries to those of the largest one.
+
+	const int r = std::distance(n.begin(), std::max_element(n.begin(), n.end()));
+	const SubpathRef &reference = subpaths[r];
+	const int samples = 16;
+
+	std::vector<float> lengths;
+	computeArcLengths(reference->nsvg.pts, n[r], samples, lengths);
+	const float total = lengths.back();
+
+	std::vector<float> boundaries(n[r] - 1);
+	for (int i = 0; i < n[r] - 1; i++) {
+		boundaries[i] = lengths[(i + 1) * samples] / total;
+	}
+
+	for (int i = 0; i < int(n.size()); i++) {
+		if (n[i] < n[r]) {
+			subpaths[i]->refineTo(boundaries);
+		}
+	}
+
 	return true;
 }
 
 void Subpath::setPoints(const float *pts, int npts, bool add_loop) {
+	ownPoints();
 	const bool loop = add_loop && isClosed() && npts > 0;
 	const int n1 = npts + (loop ? 1 : 0);
 	setNumPoints(n1);
@@ -957,6 +1214,66 @@ void Subpath::setPoints(const float *pts, int npts, bool add_loop) {
 	changed(CHANGED_POINTS);
 }
 
+void Subpath::computeSubdivisionLevels(
+	std::vector<uint8_t> &out, int maxDepth, float tolerance) const {
+
+	const int n = ncurves(nsvg.npts);
+	out.resize(n);
+	for (int i = 0; i < n; i++) {
+		const float *p = nsvg.pts + i * 6;
+
+		// Wang's formula: n segments keep the distance to the curve
+		// below tolerance if n^2 >= 3/4 max|P[k] - 2 P[k+1] + P[k+2]| / tol.
+		float m = 0.0f;
+		for (int k = 0; k < 2; k++) {
+			const float *q = p + k * 2;
+			const float ddx = q[0] - 2.0f * q[2] + q[4];
+			const float ddy = q[1] - 2.0f * q[3] + q[5];
+			m = std::max(m, ddx * ddx + ddy * ddy);
+		}
+		const float segments2 = 0.75f * std::sqrt(m) / tolerance;
+
+		int level = 0;
+		while (level < maxDepth && float(1 << (2 * level)) < segments2) {
+			level++;
+		}
+		out[i] = level;
+	}
+}
+
+const uint8_t *Subpath::getSubdivisionLevels(int maxDepth, float tolerance) const {
+	const int n = ncurves(nsvg.npts);
+
+	if (levelsDepth == maxDepth && levelsTolerance == tolerance &&
+		int(levels.size()) == n) {
+		return levels.data();
+	}
+
+	if (frozen && sharedPoints) {
+		// frozen subpaths might be read by several threads at once, so
+		// we cannot write our own levels. instead, they go with the
+		// points, so that the original and all clones sharing them see
+		// the same levels; the next clone copies them (see constructor).
+		std::lock_guard<std::mutex> lock(sharedPoints->levelsMutex);
+		for (const auto &cached : sharedPoints->levels) {
+			if (cached.depth == maxDepth && cached.tolerance == tolerance) {
+				return cached.values.data();
+			}
+		}
+		sharedPoints->levels.push_back(
+			SharedPoints::Levels{maxDepth, tolerance, std::vector<uint8_t>()});
+		SharedPoints::Levels &added = sharedPoints->levels.back();
+		computeSubdivisionLevels(added.values, maxDepth, tolerance);
+		return added.values.data();
+	}
+
+	assert(!frozen || n == 0);
+	computeSubdivisionLevels(levels, maxDepth, tolerance);
+	levelsDepth = maxDepth;
+	levelsTolerance = tolerance;
+	return levels.data();
+}
+
 bool Subpath::isCollinear(int u, int v, int w) const {
 	const int n = nsvg.npts - (isClosed() ? 1 : 0);
 	if (n < 1) {
@@ -1061,6 +1378,7 @@ void Subpath::setCommandValue(int commandIndex, int what, float value) {
 		return;
 	}
 
+	ownPoints();
 	Command &command = commands[commandIndex];
 	switch (command.type) {
 		case TOVE_MOVE_TO: {
@@ -1124,6 +1442,7 @@ void Subpath::setCommandDirty(int commandIndex) {
 	if (commandIndex < 0 ||commandIndex >= n) {
 		return;
 	}
+	ownPoints();
 	commands[commandIndex].dirty = true;
 	dirty |= DIRTY_COMMANDS;
 }
@@ -1155,6 +1474,7 @@ void Subpath::updateBounds() {
 }
 
 void Subpath::set(const SubpathRef &t, const nsvg::Transform &transform) {
+	ownPoints();
 	commit();
 	t->commit();
 	const int npts = t->nsvg.npts;
@@ -1174,6 +1494,7 @@ bool Subpath::isLoop() const {
 void Subpath::fixLoop() {
 	const int npts = nsvg.npts;
 	if (npts > 0 && isClosed()) {
+		ownPoints();
 		nsvg.pts[npts * 2 - 2] = nsvg.pts[0];
 		nsvg.pts[npts * 2 - 1] = nsvg.pts[1];
 	}
@@ -1274,6 +1595,7 @@ std::ostream &Subpath::dump(std::ostream &os) {
 #endif
 
 bool Subpath::animate(const SubpathRef &a, const SubpathRef &b, float t) {
+	ownPoints();
 	commands.clear();
 
 	const int nptsA = a->nsvg.npts;
@@ -1313,6 +1635,32 @@ bool Subpath::animate(const SubpathRef &a, const SubpathRef &b, float t) {
 	return true;
 }
 
+bool Subpath::blend(const SubpathRef *keys, const float *weights, int n) {
+	// sets points to a weighted sum of keys' points, e.g. for spline
+	// interpolation across keyframes. all keys need the same point count.
+
+	const int npts = nsvg.npts;
+	for (int k = 0; k < n; k++) {
+		if (keys[k]->nsvg.npts != npts) {
+			return false;
+		}
+	}
+
+	ownPoints();
+	commands.clear();
+
+	for (int i = 0; i < npts * 2; i++) {
+		float p = 0.0f;
+		for (int k = 0; k < n; k++) {
+			p += keys[k]->nsvg.pts[i] * weights[k];
+		}
+		nsvg.pts[i] = p;
+	}
+
+	changed(CHANGED_POINTS);
+	return true;
+}
+
 void Subpath::updateNSVG() {
 	// NanoSVG will crash if we give it incomplete curves. so we duplicate points
 	// to make complete curves here.
@@ -1332,26 +1680,64 @@ void Subpath::updateNSVG() {
 	updateBounds();
 }
 
+void Subpath::freeze() {
+	updateNSVG();
+	ensureCurveData(DIRTY_COEFFICIENTS | DIRTY_CURVE_BOUNDS);
+	frozen = true;
+}
+
+void Subpath::addMemoryUsage(ToveMemoryUsage &usage) const {
+	usage.nsvg += sizeof(nsvg);
+	if (nsvg.pts) {
+		footprint::add(usage.points, usage,
+			nsvg.npts * 2 * sizeof(float),
+			capacity * 2 * sizeof(float));
+	}
+	footprint::add(usage.points, usage, commands);
+	footprint::add(usage.points, usage, curves);
+	footprint::add(usage.points, usage, curvature);
+	footprint::add(usage.points, usage, levels);
+}
+
+void Subpath::compact() {
+	if (frozen) {
+		return; // might be read by other threads.
+	}
+
+	if (!sharedPoints && capacity != nsvg.npts) {
+		float *pts = nullptr;
+		if (nsvg.npts > 0) {
+			pts = allocatePoints(nsvg.npts);
+			std::memcpy(pts, nsvg.pts, nsvg.npts * 2 * sizeof(float));
+		}
+		freePoints(nsvg.pts, capacity);
+		nsvg.pts = pts;
+		capacity = nsvg.npts;
+	}
+
+	commands.shrink_to_fit();
+	curves.shrink_to_fit();
+	curvature.shrink_to_fit();
+	levels.shrink_to_fit();
+}
+
 void Subpath::changed(ToveChangeFlags flags) {
 	dirty |= DIRTY_BOUNDS | DIRTY_COEFFICIENTS | DIRTY_CURVE_BOUNDS;
+	if (flags & CHANGED_GEOMETRY) {
+		levelsDepth = -1;
+	}
 	broadcastChange(flags);
 }
 
 void Subpath::invert() {
+	ownPoints();
 	commit();
 	const int n = nsvg.npts;
-	const size_t size = n * 2 * sizeof(float);
-	float *pts = static_cast<float*>(malloc(size));
-	if (!pts) {
-		throw std::bad_alloc();
-	}
-	for (int i = 0; i < n; i++) {
+	for (int i = 0; i < n / 2; i++) {
 		const int j = n - 1 - i;
-		pts[i * 2 + 0] = nsvg.pts[j * 2 + 0];
-		pts[i * 2 + 1] = nsvg.pts[j * 2 + 1];
+		std::swap(nsvg.pts[i * 2 + 0], nsvg.pts[j * 2 + 0]);
+		std::swap(nsvg.pts[i * 2 + 1], nsvg.pts[j * 2 + 1]);
 	}
-	free(nsvg.pts);
-	nsvg.pts = pts;
 
 	for (int i = 0; i < commands.size(); i++) {
 		commands[i].index = n - 1 - commands[i].index;
@@ -1361,6 +1747,7 @@ void Subpath::invert() {
 }
 
 void Subpath::clean(const float eps) {
+	ownPoints();
 	commit();
 	const int n = nsvg.npts;
 
@@ -1474,6 +1861,7 @@ void Subpath::setPointValue(int index, int dim, float value) {
 		index = umod(index, n);
 	}
 	if (index >= 0 && index < n && (dim & 1) == dim) {
+		ownPoints();
 		commit();
 		nsvg.pts[2 * index + dim] = value;
 		if (isClosed()) {
@@ -1486,6 +1874,7 @@ void Subpath::setPointValue(int index, int dim, float value) {
 }
 
 void Subpath::setCommandPoint(const Command &command, int what, float value) {
+	ownPoints();
 	float *p = nsvg.pts;
 	int index = command.index + command.direction * (what / 2);
 	p[2 * index + (what & 1)] = value;
@@ -1508,17 +1897,8 @@ void Subpath::updateCurveData(uint8_t flags) const {
 	const int nc = ncurves(npts);
 	curves.resize(nc);
 
-	for (int curve = 0; curve < nc; curve++) {
-		const float *p = &pts[curve * 2 * 3];
-		CurveData &c = curves[curve];
-
-		if (flags & DIRTY_COEFFICIENTS) {
-			c.updatePCs(p);
-		}
-		if (flags & DIRTY_CURVE_BOUNDS) {
-			c.updateBounds(p);
-		}
-	}
+	CurveData::updateBatch(curves.data(), pts, nc,
+		flags & DIRTY_COEFFICIENTS, flags & DIRTY_CURVE_BOUNDS);
 
 	dirty &= ~flags;
 }
@@ -18,8 +18,11 @@
 #include "gpux/curve_data.h"
 #include "nsvg.h"
 #include "utils.h"
+#include "footprint.h"
 #include "intersect.h"
 #include "mesh/area.h"
+#include <list>
+#include <mutex>
 
 BEGIN_TOVE_NAMESPACE
 
@@ -50,6 +53,47 @@ private:
 	std::vector<ToveCurvature> curvature;
 	mutable uint8_t dirty;
 
+	mutable std::vector<uint8_t> levels;
+	mutable int levelsDepth;
+	mutable float levelsTolerance;
+
+	int capacity; // of nsvg.pts, in points (see allocatePoints)
+	bool frozen;
+
+	// copy-on-write clones share their points with the original until
+	// either one gets modified; all mutators call ownPoints() first.
+	struct SharedPoints {
+		float *pts;
+		int capacity;
+
+		// subdivision levels requested from frozen clones. they are
+		// computed once for these points and never change afterwards,
+		// see getSubdivisionLevels().
+		struct Levels {
+			int depth;
+			float tolerance;
+			std::vector<uint8_t> values;
+		};
+		std::mutex levelsMutex;
+		std::list<Levels> levels;
+
+		inline ~SharedPoints() {
+			freePoints(pts, capacity);
+		}
+	};
+	SharedPtr<SharedPoints> sharedPoints;
+
+	inline void ownPoints() {
+		if (sharedPoints) {
+			unsharePoints();
+		}
+	}
+
+	void unsharePoints();
+
+	void computeSubdivisionLevels(
+		std::vector<uint8_t> &out, int maxDepth, float tolerance) const;
+
 	float *addPoints(int n, bool allowClosedEdit = false);
 
 	inline void addPoint(float x, float y, bool allowClosedEdit = false) {
@@ -87,10 +131,12 @@ public:
 
 	Subpath();
 	Subpath(const NSVGpath *path);
-	Subpath(const SubpathRef &t);
+	Subpath(const SubpathRef &t, bool copyOnWrite = false);
 
 	inline ~Subpath() {
-		free(nsvg.pts);
+		if (!sharedPoints) {
+			freePoints(nsvg.pts, capacity);
+		}
 	}
 
     inline void commit() const {
@@ -114,7 +160,10 @@ public:
 	void rotate(ToveElementType what, int k);
 
 	void refine(const int factor);
-	static bool morphify(const std::vector<SubpathRef> &subpaths);
+	void refineTo(const std::vector<float> &reference);
+	static bool morphify(
+		const std::vector<SubpathRef> &subpaths,
+		ToveMorphStrategy strategy = TOVE_MORPH_MINIMAL);
 
     void makeFlat(int k, int dir);
     void makeSmooth(int k, int dir, float a = 0.5);
@@ -156,6 +205,7 @@ public:
         }
         const int i = curve * 3 * 2 + index + 2;
         if (i >= 0 && i < npts * 2) {
+			ownPoints();
 			nsvg.pts[i] = value;
 			changed(CHANGED_POINTS);
 		}
@@ -178,6 +228,16 @@ public:
     bool isCollinear(int u, int v, int w) const;
     bool isLineAt(int k, int dir) const;
 
+    inline bool isLine(int curve) const {
+        ensureCurveData(DIRTY_COEFFICIENTS);
+        return curves[curve].line;
+    }
+
+    // per-curve subdivision levels for rigid flattening, chosen from each
+    // curve's flatness. they are kept until the next CHANGED_GEOMETRY, so
+    // that vertex counts stay fixed while points get animated.
+    const uint8_t *getSubdivisionLevels(int maxDepth, float tolerance) const;
+
 	inline float getCommandPoint(const Command &command, int what) {
 		const float *p = nsvg.pts + 2 * command.index;
 		return p[command.direction * (what / 2) * 2 + (what & 1)];
@@ -202,6 +262,12 @@ public:
 		return nsvg.pts;
 	}
 
+	// for writing points directly.
+	inline float *editPoints() {
+		ownPoints();
+		return getPoints();
+	}
+
 	inline bool isClosed() const {
 		return nsvg.closed;
 	}
@@ -228,6 +294,7 @@ public:
 		ExCurveData &extended);
 
 	bool animate(const SubpathRef &a, const SubpathRef &b, float t);
+	bool blend(const SubpathRef *keys, const float *weights, int n);
 
 	inline void setNext(const SubpathRef &trajectory) {
 		nsvg.next = &trajectory->nsvg;
@@ -235,6 +302,21 @@ public:
 
 	void updateNSVG();
 
+	// brings all lazily computed data up to date, so that the subpath
+	// can be read from several threads. frozen subpaths must not be
+	// modified anymore.
+	void freeze();
+
+	inline bool isFrozen() const {
+		return frozen;
+	}
+
+	void addMemoryUsage(ToveMemoryUsage &usage) const;
+
+	// trims point and curve storage to its current size. for static
+	// content; the next edit grows it again.
+	void compact();
+
 	void changed(ToveChangeFlags flags);
 
 	void invert();
@@ -271,6 +353,24 @@ public:
 	inline SubpathCleaner() : n(0), allocated(0) {
 	}
 
+	inline void addMemoryUsage(double &category, ToveMemoryUsage &usage) const {
+		// scratch space, so all of it is reclaimable.
+		footprint::add(category, usage, 0, pts.capacity() * sizeof(vec2));
+		footprint::add(category, usage, 0, good.capacity() * sizeof(uint8_t));
+		footprint::add(category, usage, 0,
+			indices.capacity() * sizeof(ToveVertexIndex));
+		vanishing.addMemoryUsage(category, usage);
+	}
+
+	inline void release() {
+		footprint::release(pts);
+		footprint::release(good);
+		footprint::release(indices);
+		vanishing.release();
+		n = 0;
+		allocated = 0;
+	}
+
 	inline void init(const int maxSize, const int numTotal = 0) {
 		if (maxSize > allocated) {
 			pts.resize(maxSize + 2);
@@ -0,0 +1,460 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "timeline.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+BEGIN_TOVE_NAMESPACE
+
+Timeline::Timeline() :
+	mode(TOVE_TIMELINE_BOUNCE),
+	interpolation(TOVE_INTERPOLATE_LINEAR),
+	tension(0.0f),
+	closedLoopValid(false),
+	closedLoop(false) {
+}
+
+void Timeline::addKeyframe(
+	const GraphicsRef &graphics, float duration, ToveEasing easing) {
+
+	if (keyframes.empty()) {
+		duration = 0.0f;
+	} else {
+		duration = std::max(duration, 0.0f);
+	}
+
+	keyframes.push_back(Keyframe{graphics, duration, easing});
+	times.push_back(getDuration() + duration);
+	closedLoopValid = false;
+}
+
+void Timeline::setInterpolation(ToveInterpolation interpolation, float tension) {
+	this->interpolation = interpolation;
+	this->tension = tension;
+}
+
+float Timeline::localTime(float t) const {
+	const float duration = getDuration();
+	if (duration <= 0.0f) {
+		return 0.0f;
+	}
+
+	switch (mode) {
+		case TOVE_TIMELINE_LOOP: {
+			t = std::fmod(t, duration);
+			return t < 0.0f ? t + duration : t;
+		} break;
+
+		case TOVE_TIMELINE_BOUNCE: {
+			t = std::fmod(t, 2.0f * duration);
+			if (t < 0.0f) {
+				t += 2.0f * duration;
+			}
+			return t > duration ? 2.0f * duration - t : t;
+		} break;
+
+		default: {
+			return clamp(t, 0.0f, duration);
+		} break;
+	}
+}
+
+int Timeline::findSegment(float t) const {
+	// returns the keyframe index i such that t lies in [times[i], times[i + 1]].
+	const auto i = std::upper_bound(times.begin(), times.end(), t);
+	const int n = keyframes.size();
+	return std::max(0, std::min(
+		int(std::distance(times.begin(), i)) - 1, n - 2));
+}
+
+bool Timeline::computeClosedLoop() const {
+	// in loop mode, the last keyframe is directly followed by the first
+	// one. if both are the same shape, the spline can pass through that
+	// point smoothly by treating them as one keyframe.
+
+	const int n = keyframes.size();
+	if (mode != TOVE_TIMELINE_LOOP || n < 3) {
+		return false;
+	}
+
+	const Graphics *first = keyframes[0].graphics.get();
+	const Graphics *last = keyframes[n - 1].graphics.get();
+	if (first == last) {
+		return true;
+	}
+
+	const int numPaths = first->getNumPaths();
+	if (last->getNumPaths() != numPaths) {
+		return false;
+	}
+	for (int p = 0; p < numPaths; p++) {
+		const PathRef &a = first->getPath(p);
+		const PathRef &b = last->getPath(p);
+		const int numSubpaths = a->getNumSubpaths();
+		if (b->getNumSubpaths() != numSubpaths) {
+			return false;
+		}
+		for (int s = 0; s < numSubpaths; s++) {
+			const NSVGpath &pa = a->getSubpath(s)->nsvg;
+			const NSVGpath &pb = b->getSubpath(s)->nsvg;
+			if (pa.npts != pb.npts || std::memcmp(
+				pa.pts, pb.pts, pa.npts * 2 * sizeof(float)) != 0) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool Timeline::isClosedLoop() const {
+	const int n = keyframes.size();
+	if (n < 1) {
+		return false;
+	}
+
+	const uint32_t firstVersion = keyframes[0].graphics->getVersion();
+	const uint32_t lastVersion = keyframes[n - 1].graphics->getVersion();
+	if (!closedLoopValid ||
+		closedLoopVersions[0] != firstVersion ||
+		closedLoopVersions[1] != lastVersion) {
+		closedLoop = computeClosedLoop();
+		closedLoopVersions[0] = firstVersion;
+		closedLoopVersions[1] = lastVersion;
+		closedLoopValid = true;
+	}
+	return closedLoop;
+}
+
+void Timeline::computeWeights(
+	int segment, float u, bool closed, float *weights) const {
+
+	// computes cubic hermite weights for the keyframes around segment
+	// (segment - 1, segment, segment + 1, segment + 2). tangents are
+	// computed as in a cardinal spline, i.e. tension 0 gives Catmull-Rom.
+	// in closed loops, durations wrap around like the keyframes in
+	// evaluate(); open loops wrap in no time, so we use d1 there.
+
+	const int n = keyframes.size();
+
+	float d0, d1, d2;
+	d1 = keyframes[segment + 1].duration;
+
+	if (interpolation == TOVE_INTERPOLATE_HERMITE && d1 > 0.0f) {
+		if (segment > 0) {
+			d0 = keyframes[segment].duration;
+		} else {
+			d0 = closed ? keyframes[n - 1].duration : d1;
+		}
+		if (segment + 2 < n) {
+			d2 = keyframes[segment + 2].duration;
+		} else {
+			d2 = closed ? keyframes[1].duration : d1;
+		}
+		if (d0 <= 0.0f) {
+			d0 = d1;
+		}
+		if (d2 <= 0.0f) {
+			d2 = d1;
+		}
+	} else {
+		d0 = 1.0f;
+		d1 = 1.0f;
+		d2 = 1.0f;
+	}
+
+	const float s = (1.0f - tension) * 0.5f;
+	const float a1 = s * d1 / d0;
+	const float b1 = s;
+	const float a2 = s;
+	const float b2 = s * d1 / d2;
+
+	const float u2 = u * u;
+	const float u3 = u2 * u;
+
+	const float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+	const float h10 = u3 - 2.0f * u2 + u;
+	const float h01 = -2.0f * u3 + 3.0f * u2;
+	const float h11 = u3 - u2;
+
+	weights[0] = -h10 * a1;
+	weights[1] = h00 + h10 * (a1 - b1) - h11 * a2;
+	weights[2] = h01 + h10 * b1 + h11 * (a2 - b2);
+	weights[3] = h11 * b2;
+}
+
+void Timeline::evaluate(const GraphicsRef &target, float t) const {
+	const int n = keyframes.size();
+	if (n < 1) {
+		return;
+	}
+	if (n == 1) {
+		target->animate(keyframes[0].graphics, keyframes[0].graphics, 0.0f);
+		return;
+	}
+
+	t = localTime(t);
+
+	const int i = findSegment(t);
+	const Keyframe &next = keyframes[i + 1];
+
+	float u = next.duration > 0.0f ? (t - times[i]) / next.duration : 1.0f;
+	u = ease(next.easing, clamp(u, 0.0f, 1.0f));
+
+	// linear animation takes care of everything that is not a point,
+	// e.g. colors and line widths, and of structural setup of target.
+	target->animate(keyframes[i].graphics, next.graphics, u);
+
+	if (interpolation == TOVE_INTERPOLATE_LINEAR) {
+		return;
+	}
+
+	// in a closed loop, the last keyframe is the first one, so the
+	// neighbours across the wrap are n - 2 and 1. open loops jump from
+	// the last keyframe to the first one; they wrap to n - 1 and 0.
+	const bool loop = mode == TOVE_TIMELINE_LOOP && n > 2;
+	const bool closed = loop && isClosedLoop();
+
+	int k[4];
+	k[0] = i > 0 ? i - 1 : (closed ? n - 2 : (loop ? n - 1 : i));
+	k[1] = i;
+	k[2] = i + 1;
+	k[3] = i + 2 < n ? i + 2 : (closed ? 1 : (loop ? 0 : i + 1));
+
+	float weights[4];
+	computeWeights(i, u, closed, weights);
+
+	const Graphics *g[4];
+	for (int j = 0; j < 4; j++) {
+		g[j] = keyframes[k[j]].graphics.get();
+	}
+
+	const int numPaths = target->getNumPaths();
+	for (int j = 0; j < 4; j++) {
+		if (g[j]->getNumPaths() != numPaths) {
+			return;
+		}
+	}
+
+	SubpathRef subpaths[4];
+	for (int p = 0; p < numPaths; p++) {
+		const PathRef path = target->getPath(p);
+		const int numSubpaths = path->getNumSubpaths();
+
+		bool match = true;
+		for (int j = 0; j < 4; j++) {
+			if (g[j]->getPath(p)->getNumSubpaths() != numSubpaths) {
+				match = false;
+				break;
+			}
+		}
+		if (!match) {
+			continue;
+		}
+
+		for (int s = 0; s < numSubpaths; s++) {
+			for (int j = 0; j < 4; j++) {
+				subpaths[j] = g[j]->getPath(p)->getSubpath(s);
+			}
+			path->getSubpath(s)->blend(subpaths, weights, 4);
+		}
+	}
+}
+
+int Timeline::getNumFrames(float fps) const {
+	if (keyframes.empty() || fps <= 0.0f) {
+		return 0;
+	}
+
+	const float duration = getDuration();
+	int n = int(std::floor(duration * fps)) + 1;
+
+	if (mode == TOVE_TIMELINE_LOOP && n > 1 && (n - 1) / fps >= duration) {
+		n -= 1; // last frame would duplicate the first one.
+	}
+
+	return n;
+}
+
+ToveAtlasLayout Timeline::getAtlasLayout(
+	float fps, int frameWidth, int frameHeight, int padding, int maxWidth) const {
+
+	ToveAtlasLayout layout;
+	std::memset(&layout, 0, sizeof(layout));
+
+	const int n = getNumFrames(fps);
+	if (n < 1 || frameWidth < 1 || frameHeight < 1) {
+		return layout;
+	}
+
+	padding = std::max(padding, 0);
+
+	int columns;
+	if (maxWidth > 0) {
+		columns = (maxWidth + padding) / (frameWidth + padding);
+	} else {
+		columns = int(std::ceil(std::sqrt(float(n))));
+	}
+	columns = std::max(1, std::min(columns, n));
+	const int rows = (n + columns - 1) / columns;
+
+	layout.numFrames = n;
+	layout.columns = columns;
+	layout.rows = rows;
+	layout.frameWidth = frameWidth;
+	layout.frameHeight = frameHeight;
+	layout.padding = padding;
+	layout.width = columns * frameWidth + (columns - 1) * padding;
+	layout.height = rows * frameHeight + (rows - 1) * padding;
+
+	return layout;
+}
+
+bool Timeline::rasterizeAtlas(
+	const ToveAtlasLayout &layout,
+	float fps,
+	uint8_t *pixels, int stride,
+	float tx, float ty, float scale,
+	const ToveRasterizeSettings *settings,
+	int numThreads,
+	ToveAtlasFrame *frames) const {
+
+	const int n = layout.numFrames;
+	if (n < 1 || n > layout.columns * layout.rows ||
+		!pixels || stride < layout.width * 4 || fps <= 0.0f) {
+		return false;
+	}
+
+	// bring all keyframes (and our closed loop cache) into a stable
+	// state before reading them concurrently from the worker threads.
+	for (const Keyframe &keyframe : keyframes) {
+		keyframe.graphics->getImage();
+	}
+	isClosedLoop();
+
+	std::memset(pixels, 0, size_t(layout.height) * stride);
+
+	const int frameWidth = layout.frameWidth;
+	const int frameHeight = layout.frameHeight;
+	const int spacing = layout.padding;
+
+	std::atomic<int> next(0);
+	std::atomic<bool> success(true);
+
+	// each worker reuses its own target graphics and its own
+	// (thread local) rasterizer for all the frames it renders.
+	const auto work = [&] () {
+		try {
+			const GraphicsRef target = tove_make_shared<Graphics>();
+
+			int i;
+			while ((i = next++) < n) {
+				const int x = (i % layout.columns) * (frameWidth + spacing);
+				const int y = (i / layout.columns) * (frameHeight + spacing);
+				const float t = i / fps;
+
+				evaluate(target, t);
+				target->rasterize(
+					pixels + size_t(y) * stride + x * 4,
+					frameWidth, frameHeight, stride,
+					tx, ty, scale, settings);
+
+				if (frames) {
+					ToveAtlasFrame &frame = frames[i];
+					frame.t = t;
+					frame.u0 = x / float(layout.width);
+					frame.v0 = y / float(layout.height);
+					frame.u1 = (x + frameWidth) / float(layout.width);
+					frame.v1 = (y + frameHeight) / float(layout.height);
+				}
+			}
+		} catch (...) {
+			success = false;
+			next = n;
+		}
+	};
+
+	if (numThreads < 1) {
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	numThreads = std::min(numThreads, n);
+
+	// reports from the workers (e.g. from animate) reach the report
+	// function on this thread, like those of jobs (see jobs.cpp).
+	std::vector<report::Deferred> reports(numThreads - 1);
+
+	std::vector<std::thread> threads;
+	threads.reserve(numThreads - 1);
+	for (int i = 1; i < numThreads; i++) {
+		report::Deferred *deferred = &reports[i - 1];
+		threads.emplace_back([&work, deferred] () {
+			report::deferred = deferred;
+			work();
+			report::deferred = nullptr;
+		});
+	}
+	work();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	for (const auto &deferred : reports) {
+		for (const auto &r : deferred) {
+			report::report(r.first.c_str(), r.second);
+		}
+	}
+
+	if (!success && tove::report::warnings()) {
+		tove::report::warn("failed to rasterize all atlas frames.");
+	}
+
+	return success;
+}
+
+float Timeline::ease(ToveEasing easing, float t) {
+	switch (easing) {
+		case TOVE_EASE_IN_QUAD:
+			return t * t;
+		case TOVE_EASE_OUT_QUAD:
+			return t * (2.0f - t);
+		case TOVE_EASE_IN_OUT_QUAD:
+			return t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
+		case TOVE_EASE_IN_CUBIC:
+			return t * t * t;
+		case TOVE_EASE_OUT_CUBIC: {
+			const float s = t - 1.0f;
+			return s * s * s + 1.0f;
+		}
+		case TOVE_EASE_IN_OUT_CUBIC: {
+			if (t < 0.5f) {
+				return 4.0f * t * t * t;
+			}
+			const float s = 2.0f * t - 2.0f;
+			return 0.5f * s * s * s + 1.0f;
+		}
+		case TOVE_EASE_IN_SINE:
+			return 1.0f - std::cos(t * float(M_PI) * 0.5f);
+		case TOVE_EASE_OUT_SINE:
+			return std::sin(t * float(M_PI) * 0.5f);
+		case TOVE_EASE_IN_OUT_SINE:
+			return 0.5f * (1.0f - std::cos(t * float(M_PI)));
+		case TOVE_EASE_STEP:
+			return t < 1.0f ? 0.0f : 1.0f;
+		default:
+			return t;
+	}
+}
+
+END_TOVE_NAMESPACE
@@ -0,0 +1,99 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_TIMELINE
+#define __TOVE_TIMELINE 1
+
+#include "graphics.h"
+#include <vector>
+
+BEGIN_TOVE_NAMESPACE
+
+class Timeline : public Referencable {
+public:
+	struct Keyframe {
+		GraphicsRef graphics;
+		float duration; // time from the previous keyframe to this one
+		ToveEasing easing; // easing of the transition into this keyframe
+	};
+
+private:
+	std::vector<Keyframe> keyframes;
+	std::vector<float> times;
+
+	ToveTimelineMode mode;
+	ToveInterpolation interpolation;
+	float tension;
+
+	// caches isClosedLoop() while the first and last keyframes keep
+	// their versions; addKeyframe() and setMode() invalidate it.
+	mutable bool closedLoopValid;
+	mutable bool closedLoop;
+	mutable uint32_t closedLoopVersions[2];
+
+	float localTime(float t) const;
+	int findSegment(float t) const;
+	bool computeClosedLoop() const;
+	bool isClosedLoop() const;
+
+	void computeWeights(int segment, float u, bool closed, float *weights) const;
+
+public:
+	// timelines start out in TOVE_TIMELINE_BOUNCE mode.
+	Timeline();
+
+	void addKeyframe(const GraphicsRef &graphics, float duration, ToveEasing easing);
+
+	inline int getNumKeyframes() const {
+		return keyframes.size();
+	}
+
+	inline const Keyframe &getKeyframe(int i) const {
+		return keyframes.at(i);
+	}
+
+	inline float getDuration() const {
+		return times.empty() ? 0.0f : times.back();
+	}
+
+	inline void setMode(ToveTimelineMode mode) {
+		this->mode = mode;
+		closedLoopValid = false;
+	}
+
+	inline ToveTimelineMode getMode() const {
+		return mode;
+	}
+
+	void setInterpolation(ToveInterpolation interpolation, float tension);
+
+	void evaluate(const GraphicsRef &target, float t) const;
+
+	int getNumFrames(float fps) const;
+
+	ToveAtlasLayout getAtlasLayout(float fps,
+		int frameWidth, int frameHeight, int padding, int maxWidth) const;
+
+	bool rasterizeAtlas(
+		const ToveAtlasLayout &layout,
+		float fps,
+		uint8_t *pixels, int stride,
+		float tx, float ty, float scale,
+		const ToveRasterizeSettings *settings,
+		int numThreads,
+		ToveAtlasFrame *frames) const;
+
+	static float ease(ToveEasing easing, float t);
+};
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_TIMELINE
@@ -0,0 +1,225 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "trace.h"
+
+#if TOVE_TRACE
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#endif
+
+BEGIN_TOVE_NAMESPACE
+
+namespace trace {
+
+#if TOVE_TRACE
+
+namespace {
+
+struct Event {
+	const char *name;
+	uint64_t begin;
+	uint64_t end;
+};
+
+// events per thread; older ones get overwritten.
+const int ringSize = 1 << 14;
+
+// rings of ended threads whose events we keep until the next clear;
+// beyond this, the oldest ones get dropped.
+const size_t maxRetiredRings = 64;
+
+struct Ring {
+	std::mutex mutex; // only ever contended while exporting
+	int tid;
+	std::vector<Event> events;
+	uint64_t written;
+
+	Ring() : tid(0), events(ringSize), written(0) {
+	}
+};
+
+typedef std::shared_ptr<Ring> RingRef;
+
+struct Registry {
+	std::mutex mutex;
+	std::vector<RingRef> active; // rings of running threads
+	std::deque<RingRef> retired; // of ended threads, not yet cleared
+	std::vector<RingRef> free; // ready for reuse by new threads
+	int nextTid;
+	const std::chrono::steady_clock::time_point origin;
+
+	Registry() : nextTid(1), origin(std::chrono::steady_clock::now()) {
+	}
+
+	// like the job queue, the registry lives until the process ends,
+	// since worker threads may still record during static destruction.
+	static Registry &get() {
+		static Registry *registry = new Registry();
+		return *registry;
+	}
+
+	Ring *acquire() {
+		std::lock_guard<std::mutex> lock(mutex);
+		RingRef ring;
+		if (free.empty()) {
+			ring = std::make_shared<Ring>();
+		} else {
+			ring = free.back();
+			free.pop_back();
+		}
+		ring->tid = nextTid++;
+		ring->written = 0;
+		active.push_back(ring);
+		return ring.get();
+	}
+
+	void retire(Ring *ring) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto i = std::find_if(active.begin(), active.end(),
+			[ring] (const RingRef &r) { return r.get() == ring; });
+		if (i == active.end()) {
+			return;
+		}
+		if (ring->written > 0) {
+			retired.push_back(*i);
+		} else {
+			free.push_back(*i);
+		}
+		active.erase(i);
+		while (retired.size() > maxRetiredRings) {
+			free.push_back(retired.front());
+			retired.pop_front();
+		}
+	}
+
+	// called with mutex held, once retired rings have been cleared.
+	void recycle() {
+		free.insert(free.end(), retired.begin(), retired.end());
+		retired.clear();
+	}
+};
+
+// a thread's ring goes back to the registry when the thread ends, so
+// that rasterizeAtlas and other short-lived workers reuse rings instead
+// of adding new ones.
+struct ThreadRing {
+	Ring *ring;
+
+	ThreadRing() : ring(nullptr) {
+	}
+
+	~ThreadRing() {
+		if (ring) {
+			Registry::get().retire(ring);
+		}
+	}
+};
+
+Ring &ring() {
+	thread_local ThreadRing local;
+	if (!local.ring) {
+		local.ring = Registry::get().acquire();
+	}
+	return *local.ring;
+}
+
+} // namespace
+
+std::atomic<bool> enabled(true);
+
+uint64_t now() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - Registry::get().origin).count();
+}
+
+void record(const char *name, uint64_t begin, uint64_t end) {
+	Ring &r = ring();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	r.events[r.written % ringSize] = Event{name, begin, end};
+	r.written++;
+}
+
+void setEnabled(bool enable) {
+	enabled = enable;
+}
+
+void clear() {
+	Registry &registry = Registry::get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (const auto &r : registry.active) {
+		std::lock_guard<std::mutex> ringLock(r->mutex);
+		r->written = 0;
+	}
+	registry.recycle();
+}
+
+std::string exportJSON() {
+	std::vector<std::pair<int, Event>> events;
+	{
+		Registry &registry = Registry::get();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		const auto add = [&events] (const RingRef &r) {
+			std::lock_guard<std::mutex> ringLock(r->mutex);
+			const uint64_t n = std::min(r->written, uint64_t(ringSize));
+			for (uint64_t i = r->written - n; i < r->written; i++) {
+				events.emplace_back(r->tid, r->events[i % ringSize]);
+			}
+		};
+		for (const auto &r : registry.active) {
+			add(r);
+		}
+		for (const auto &r : registry.retired) {
+			add(r);
+		}
+	}
+
+	std::ostringstream out;
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	out << "{\"traceEvents\":[";
+	bool first = true;
+	for (const auto &e : events) {
+		if (!first) {
+			out << ",";
+		}
+		first = false;
+		// timestamps and durations are in microseconds.
+		out << "{\"name\":\"" << e.second.name <<
+			"\",\"cat\":\"tove\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.first <<
+			",\"ts\":" << e.second.begin / 1000.0 <<
+			",\"dur\":" << (e.second.end - e.second.begin) / 1000.0 << "}";
+	}
+	out << "],\"displayTimeUnit\":\"ms\"}";
+	return out.str();
+}
+
+#else
+
+void setEnabled(bool enable) {
+}
+
+void clear() {
+}
+
+std::string exportJSON() {
+	return "{\"traceEvents\":[]}";
+}
+
+#endif // TOVE_TRACE
+
+} // namespace trace
+
+END_TOVE_NAMESPACE
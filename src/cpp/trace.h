@@ -0,0 +1,76 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_TRACE
+#define __TOVE_TRACE 1
+
+#include "common.h"
+#include <string>
+
+#if TOVE_TRACE
+#include <atomic>
+#include <cstdint>
+#endif
+
+BEGIN_TOVE_NAMESPACE
+
+// timing of pipeline stages in Chrome's trace event format (load the
+// exported JSON in chrome://tracing or Perfetto). zones are recorded
+// into a fixed-size ring buffer per thread, so that the most recent
+// events survive; rings of ended threads are reused once cleared.
+// unless built with TOVE_TRACE, zones compile to nothing and exports
+// are empty.
+
+namespace trace {
+	void setEnabled(bool enabled);
+	void clear();
+	std::string exportJSON();
+
+#if TOVE_TRACE
+	extern std::atomic<bool> enabled;
+
+	uint64_t now();
+	void record(const char *name, uint64_t begin, uint64_t end);
+
+	class Zone {
+		const char * const name;
+		const bool active;
+		const uint64_t begin;
+
+	public:
+		inline Zone(const char *name) :
+			name(name),
+			active(enabled.load(std::memory_order_relaxed)),
+			begin(active ? now() : 0) {
+		}
+
+		inline ~Zone() {
+			if (active) {
+				record(name, begin, now());
+			}
+		}
+	};
+#endif
+} // namespace trace
+
+END_TOVE_NAMESPACE
+
+#if TOVE_TRACE
+#define TOVE_TRACE_CONCAT_(a, b) a##b
+#define TOVE_TRACE_CONCAT(a, b) TOVE_TRACE_CONCAT_(a, b)
+// times the enclosing scope. name must be a string literal.
+#define TOVE_TRACE_ZONE(name) \
+	::tove::trace::Zone TOVE_TRACE_CONCAT(_tove_zone_, __LINE__)(name)
+#else
+#define TOVE_TRACE_ZONE(name)
+#endif
+
+#endif // __TOVE_TRACE
@@ -21,6 +21,8 @@ namespace report {
 
 Configuration config = Configuration{nullptr, TOVE_REPORT_WARN};
 
+thread_local Deferred *deferred = nullptr;
+
 static std::string last_warning;
 
 void err(const char *s) {
@@ -14,6 +14,8 @@
 
 #include "common.h"
 #include "interface.h"
+#include <string>
+#include <vector>
 
 BEGIN_TOVE_NAMESPACE
 
@@ -25,13 +27,24 @@ namespace report {
 
     extern Configuration config;
 
+    typedef std::vector<std::pair<std::string, ToveReportLevel>> Deferred;
+
+    // report functions usually call into a scripting language and must
+    // not be called from worker threads. workers collect their reports
+    // here instead, and these get delivered later on the main thread.
+    extern thread_local Deferred *deferred;
+
     inline bool warnings() {
         return config.level <= TOVE_REPORT_WARN;
     }
 
     inline void report(const char *s, ToveReportLevel l) {
         if (l >= config.level && config.report) {
-            config.report(s, l);
+            if (deferred) {
+                deferred->emplace_back(s, l);
+            } else {
+                config.report(s, l);
+            }
         }
     }
 
@@ -25,8 +25,17 @@
 
 #define T_EPS 0.0
 
+#ifdef LISTS_16BIT
+// thresholds between the largest curve index (2047), the strokes marker
+// (20480) and the end marker (24576); all are exact in fp16.
+#define SENTINEL_END 22528.0
+#define SENTINEL_STROKES 16384.0
+#define LIST_IDS_PER_TEXEL 2
+#else
 #define SENTINEL_END 254.5
 #define SENTINEL_STROKES 253.5
+#define LIST_IDS_PER_TEXEL 4
+#endif
 
 #define M_PI 3.1415926535897932384626433832795
 
@@ -46,6 +55,28 @@ uniform float lutX[LUT_SIZE];
 uniform float lutY[LUT_SIZE];
 #endif // LUT_BANDS
 
+#ifdef GPUX_ATLAS
+// per path header: (bounds), (curves row, lists row, grid size, fill rule).
+uniform sampler2D header;
+uniform int numPaths;
+
+float curveOffset;
+int pathFillRule;
+#elif defined(GRID_CELLS)
+#define GRID_SIZE tablemeta.xy
+
+uniform ivec3 tablemeta;
+uniform vec4 bounds;
+#endif // GRID_CELLS
+
+#ifndef GPUX_ATLAS
+#define curveOffset 0.0
+#endif
+
+float curveCoord(float id) {
+	return (id + curveOffset + 0.5) / NUM_CURVES;
+}
+
 #if LINE_STYLE > 0
 #define LINE_OFFSET lineargs.x
 uniform vec2 lineargs;
@@ -53,6 +84,18 @@ uniform float line_quality;
 #define MAX_LINE_ITERATIONS 16
 #endif
 
+#ifdef LISTS_16BIT
+vec4 fetchCurveIds(vec2 blockPos) {
+	// two little-endian 16-bit curve indices per texel.
+	vec4 c = floor(Texel(lists, blockPos) * 255.0 + 0.5);
+	return vec4(c.xz + c.yw * 256.0, 0.0, 0.0);
+}
+#else
+vec4 fetchCurveIds(vec2 blockPos) {
+	return Texel(lists, blockPos) * 255.0;
+}
+#endif
+
 #ifdef GPUX_DEBUG
 uniform int debug_curve = -1;
 uniform bool debug_ray_on_x = true;
@@ -282,7 +325,10 @@ int advancedMagic(vec4 bx, vec4 by, vec4 P, float position, float upperBound) {
 }
 
 bool isInside(int z) {
-#if FILL_RULE == 0
+#ifdef GPUX_ATLAS
+	// contributions are computed as for nonzero, which keeps parity.
+	return pathFillRule == 0 ? z != 0 : mod(float(z), 2.0) > 0.5;
+#elif FILL_RULE == 0
 	return z != 0;
 #elif FILL_RULE == 1
 	return mod(z, 2) > 0.5;
@@ -376,32 +422,66 @@ vec4 do_color(vec2 textureUV) {
 	vec2 blockPos = rayOnX ?
 		vec2(0, (at.y - 1 + 0.5) / float(LISTS_H) + 0.5f) :
 		vec2(0, (at.x - 1 + 0.5) / float(LISTS_H));
+	float rayFlip = 1.0;
+#elif defined(GRID_CELLS)
+	vec2 position = raw_vertex_pos.xy;
+#ifdef GPUX_ATLAS
+	float pathV = (floor(raw_vertex_pos.z + 0.5) + 0.5) / float(numPaths);
+	vec4 gridBounds = Texel(header, vec2(0.25, pathV));
+	vec4 pathMeta = Texel(header, vec2(0.75, pathV));
+	curveOffset = pathMeta.x;
+	pathFillRule = int(pathMeta.w + 0.5);
+	ivec2 gridSize = ivec2(int(pathMeta.z + 0.5));
+	float listsRow = pathMeta.y;
+#else
+	vec4 gridBounds = bounds;
+	ivec2 gridSize = GRID_SIZE;
+	float listsRow = 0.0;
+#endif
+	vec2 cellSize = max((gridBounds.zw - gridBounds.xy) / vec2(gridSize), vec2(1e-6));
+	ivec2 cell = clamp(ivec2(floor((position - gridBounds.xy) / cellSize)),
+		ivec2(0), gridSize - ivec2(1));
+	vec2 blockPos = vec2(0, (listsRow + cell.y * gridSize.x + cell.x + 0.5) / float(LISTS_H));
+	bool rayOnX;
+	float rayFlip;
 #else // LUT_BANDS
 	vec2 position = raw_vertex_pos.xy;
 	bool rayOnX = textureUV.x > 0;
 	vec2 blockPos = vec2(0.0, textureUV.y);
+	float rayFlip = 1.0;
 #endif // LUT_BANDS
 
-	vec2 axis1 = vec2(int(rayOnX), 1 - int(rayOnX));
-	vec2 axis2 = vec2(1) - axis1;
-
-	float rayPos = dot(position, axis1);
-	vec4 C = vec4(0.0, 0.0, 0.0, dot(position, axis2));
-
 	vec2 blockStep = vec2(1.0 / LISTS_W, 0);
-	const float C_ID_SCALE = 255.0;
 	blockPos += 0.5 * blockStep;
 
-	vec4 curveIds = Texel(lists, blockPos) * C_ID_SCALE;
+	vec4 curveIds = fetchCurveIds(blockPos);
 	int shift = 0;
 	int z = 0;
 
+#ifdef GRID_CELLS
+	// the first entry of each cell's list is its ray direction,
+	// i.e. one of +x, -x, +y, -y.
+	int direction = int(curveIds.x + 0.5);
+	rayOnX = direction < 2;
+	rayFlip = (direction == 1 || direction == 3) ? -1.0 : 1.0;
+	curveIds.xyzw = curveIds.yzwx;
+	shift = 1;
+#endif
+
+	vec2 axis1 = vec2(int(rayOnX), 1 - int(rayOnX));
+	vec2 axis2 = vec2(1) - axis1;
+
+	float rayPos = dot(position, axis1) * rayFlip;
+	vec4 C = vec4(0.0, 0.0, 0.0, dot(position, axis2));
+
 #if PAINT_ORDER < 0
 	vec2 blockPos0 = blockPos;
+	vec4 curveIds0 = curveIds;
+	int shift0 = shift;
 #endif
 
 	while (curveIds.x < SENTINEL_STROKES) {
-		float curveId = (curveIds.x + 0.5) / NUM_CURVES;
+		float curveId = curveCoord(curveIds.x);
 
 		vec4 bx = Texel(curves, vec2(0.0 / CURVE_DATA_SIZE, curveId));
 		vec4 by = Texel(curves, vec2(1.0 / CURVE_DATA_SIZE, curveId));
@@ -426,12 +506,14 @@ vec4 do_color(vec2 textureUV) {
 		if (dot(off, axis2) == 0.0) {
 #endif
 
+			// for rays in negative direction (rayFlip < 0), we mirror
+			// the curve along the ray axis.
 			int zdiff = advancedMagic(
-				rayOnX ? bx : by,
+				(rayOnX ? bx : by) * rayFlip,
 				rayOnX ? by : bx,
 				rayOnX ? -by + C : bx - C,
 				rayPos,
-				dot(bounds.zw, axis1));
+				rayFlip > 0.0 ? dot(bounds.zw, axis1) : -dot(bounds.xy, axis1));
 			z += zdiff;
 
 #ifdef GPUX_DEBUG
@@ -445,7 +527,7 @@ vec4 do_color(vec2 textureUV) {
 		}
 #endif
 
-		if (++shift < 4) {
+		if (++shift < LIST_IDS_PER_TEXEL) {
 			curveIds.xyzw = curveIds.yzwx;
 		} else {
 			blockPos += blockStep;
@@ -453,7 +535,7 @@ vec4 do_color(vec2 textureUV) {
 				// something went horribly wrong.
 				return vec4(0.33, 1, 1, 1);
 			}
-			curveIds = Texel(lists, blockPos) * C_ID_SCALE;
+			curveIds = fetchCurveIds(blockPos);
 			shift = 0;
 		}
 	}
@@ -469,24 +551,24 @@ vec4 do_color(vec2 textureUV) {
 #if PAINT_ORDER < 0
 	// reset to start of path information.
 	blockPos = blockPos0;
-	curveIds = Texel(lists, blockPos) * C_ID_SCALE;
-	shift = 0;
+	curveIds = curveIds0;
+	shift = shift0;
 
 	if (true) {
 #else
 	if (curveIds.x >= SENTINEL_STROKES && curveIds.x < SENTINEL_END) {
 
-		if (++shift < 4) {
+		if (++shift < LIST_IDS_PER_TEXEL) {
 			curveIds.xyzw = curveIds.yzwx;
 		} else {
 			blockPos += blockStep;
-			curveIds = Texel(lists, blockPos) * C_ID_SCALE;
+			curveIds = fetchCurveIds(blockPos);
 			shift = 0;
 		}
 #endif
 
 		while (curveIds.x < SENTINEL_END) {
-			float curveId = (curveIds.x + 0.5) / NUM_CURVES;
+			float curveId = curveCoord(curveIds.x);
 
 			if (checkLine(curveId, position, axis1)) {
 #ifdef GPUX_DEBUG
@@ -497,7 +579,7 @@ vec4 do_color(vec2 textureUV) {
 				return computeLineColor(position);
 			}
 
-			if (++shift < 4) {
+			if (++shift < LIST_IDS_PER_TEXEL) {
 				curveIds.xyzw = curveIds.yzwx;
 			} else {
 				blockPos += blockStep;
@@ -505,7 +587,7 @@ vec4 do_color(vec2 textureUV) {
 					// something went horribly wrong.
 					return vec4(0.33, 1, 1, 1);
 				}
-				curveIds = Texel(lists, blockPos) * C_ID_SCALE;
+				curveIds = fetchCurveIds(blockPos);
 				shift = 0;
 			}
 		}
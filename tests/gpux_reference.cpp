@@ -0,0 +1,167 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// compares the coverage of RasterizeGPUXFill (i.e. what fill.frag
+// computes from the gpux textures) against nanosvg's rasterizer for
+// a couple of fixture shapes, in band and grid mode and for both
+// fill rules, and for 8-bit and 16-bit curve lists. exits with 1 if
+// any mismatch exceeds the tolerance.
+
+#include "../src/cpp/interface.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const int SIZE = 128;
+static const float SCALE = 2.0f;
+
+// fraction of covered pixels that may disagree. nanosvg antialiases
+// and we threshold at 50%, so expect some disagreement along edges.
+static const float TOLERANCE = 0.03f;
+
+struct Fixture {
+	const char *name;
+	const char *svg;
+};
+
+#define FIXTURE_SVG(SHAPE) \
+	"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"64\" height=\"64\" " \
+	"viewBox=\"0 0 64 64\">" SHAPE "</svg>"
+
+static const Fixture fixtures[] = {
+	{"circle", FIXTURE_SVG(
+		"<circle cx=\"32\" cy=\"32\" r=\"27\" fill=\"#ff0000\"/>")},
+	{"star/nonzero", FIXTURE_SVG(
+		"<path d=\"M32 4 L49 60 L4 24 L60 24 L15 60 Z\" "
+		"fill=\"#00ff00\" fill-rule=\"nonzero\"/>")},
+	{"star/evenodd", FIXTURE_SVG(
+		"<path d=\"M32 4 L49 60 L4 24 L60 24 L15 60 Z\" "
+		"fill=\"#00ff00\" fill-rule=\"evenodd\"/>")},
+	{"donut/nonzero", FIXTURE_SVG(
+		"<path d=\"M4 32 A28 28 0 1 0 60 32 A28 28 0 1 0 4 32 Z "
+		"M16 32 A16 16 0 1 1 48 32 A16 16 0 1 1 16 32 Z\" "
+		"fill=\"#0000ff\" fill-rule=\"nonzero\"/>")},
+	{"donut/evenodd", FIXTURE_SVG(
+		"<path d=\"M4 32 A28 28 0 1 0 60 32 A28 28 0 1 0 4 32 Z "
+		"M16 32 A16 16 0 1 0 48 32 A16 16 0 1 0 16 32 Z\" "
+		"fill=\"#0000ff\" fill-rule=\"evenodd\"/>")},
+	{"blob", FIXTURE_SVG(
+		"<path d=\"M8 40 C0 8 40 -4 52 16 C64 36 56 60 36 56 "
+		"C20 52 24 40 8 40 Z\" fill=\"#ffff00\"/>")},
+};
+
+// a wavy polygon with more than MAX_GPUX_CURVES_8BIT edges, so that
+// curve lists use 16-bit indices.
+static std::string wavyPolygonSVG(int n) {
+	std::ostringstream svg;
+	svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"64\" "
+		"height=\"64\" viewBox=\"0 0 64 64\"><path d=\"";
+	for (int i = 0; i < n; i++) {
+		const double phi = 2.0 * M_PI * i / n;
+		const double r = 24.0 + 4.0 * std::sin(7.0 * phi);
+		svg << (i == 0 ? "M" : " L") <<
+			32.0 + r * std::cos(phi) << " " << 32.0 + r * std::sin(phi);
+	}
+	svg << " Z\" fill=\"#ff00ff\"/></svg>";
+	return svg.str();
+}
+
+// allocates the textures that tove's lua lib would otherwise
+// allocate as LÖVE ByteData (see GeometryNoLinkData).
+struct GeometryBuffers {
+	ToveBounds bounds;
+	ToveLookupTableMeta meta;
+	std::vector<float> lookupTable[2];
+	std::vector<uint8_t> lists;
+	std::vector<tove_gpu_float_t> curves;
+
+	void bind(ToveShaderGeometryData &g) {
+		g.bounds = &bounds;
+		g.lookupTableMeta = &meta;
+		for (int i = 0; i < 2; i++) {
+			lookupTable[i].resize(g.lookupTableSize);
+			g.lookupTable[i] = lookupTable[i].data();
+		}
+
+		g.listsTextureRowBytes = g.listsTextureSize[0] * 4;
+		lists.resize(g.listsTextureRowBytes * g.listsTextureSize[1]);
+		g.listsTexture = lists.data();
+
+		g.curvesTextureRowBytes = g.curvesTextureSize[0] * 4 * sizeof(tove_gpu_float_t);
+		curves.resize(g.curvesTextureSize[0] * 4 * g.curvesTextureSize[1]);
+		g.curvesTexture = curves.data();
+	}
+};
+
+static bool compare(const Fixture &fixture, ToveGPUXAcceleration acceleration) {
+	const char *mode = acceleration == TOVE_GPUX_GRID ? "grid" : "bands";
+
+	ToveGraphicsRef graphics = NewGraphics(fixture.svg, "px", 72);
+	TovePathRef path = GraphicsGetPath(graphics, 1);
+
+	ToveFeedRef feed = NewGeometryFeedWith(path, false, acceleration);
+	ToveShaderData *data = FeedGetData(feed);
+	GeometryBuffers buffers;
+	buffers.bind(data->geometry);
+	FeedBeginUpdate(feed);
+	FeedEndUpdate(feed);
+
+	const int stride = SIZE * 4;
+	std::vector<uint8_t> gpux(stride * SIZE, 0);
+	std::vector<uint8_t> nsvg(stride * SIZE, 0);
+
+	bool ok = RasterizeGPUXFill(data, gpux.data(), SIZE, SIZE, stride, 0, 0, SCALE);
+	if (!ok) {
+		std::printf("%s [%s]: RasterizeGPUXFill failed\n", fixture.name, mode);
+	} else {
+		ToveRasterizeSettings settings;
+		SetRasterizeSettings(&settings, "fast", NoPalette(), 0, 0, nullptr, 0);
+		GraphicsRasterize(graphics, nsvg.data(), SIZE, SIZE, stride, 0, 0, SCALE, &settings);
+
+		int covered = 0;
+		int mismatches = 0;
+		for (int i = 0; i < SIZE * SIZE; i++) {
+			const bool a = gpux[i * 4 + 3] > 0;
+			const bool b = nsvg[i * 4 + 3] >= 128;
+			covered += b ? 1 : 0;
+			mismatches += a != b ? 1 : 0;
+		}
+
+		const float error = float(mismatches) / float(covered > 0 ? covered : 1);
+		ok = covered > 0 && error <= TOLERANCE;
+		std::printf("%s [%s]: %d of %d covered pixels differ (%.2f%%)%s\n",
+			fixture.name, mode, mismatches, covered, error * 100.0f,
+			ok ? "" : " FAILED");
+	}
+
+	ReleaseFeed(feed);
+	ReleasePath(path);
+	ReleaseGraphics(graphics);
+	return ok;
+}
+
+int main() {
+	bool ok = true;
+	for (const Fixture &fixture : fixtures) {
+		ok = compare(fixture, TOVE_GPUX_BANDS) && ok;
+		ok = compare(fixture, TOVE_GPUX_GRID) && ok;
+	}
+
+	const std::string wavy = wavyPolygonSVG(400);
+	const Fixture wide = {"wavy/400", wavy.c_str()};
+	ok = compare(wide, TOVE_GPUX_BANDS) && ok;
+	ok = compare(wide, TOVE_GPUX_GRID) && ok;
+	return ok ? 0 : 1;
+}